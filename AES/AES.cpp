@@ -1,7 +1,8 @@
 /*
 
 This is an implementation of the AES algorithm, specifically ECB, CTR and CBC mode.
-Block size can be chosen in aes.h - available choices are AES128, AES192, AES256.
+The key size is the template argument of AES in aes.h - AES128, AES192 and AES256
+are instantiated at the end of this file.
 
 The implementation is verified against the test vectors in:
   National Institute of Standards and Technology Special Publication 800-38A 2001 ED
@@ -45,16 +46,9 @@ NOTE:   String length must be evenly divisible by 16byte (str_len % 16 == 0)
 // The number of columns comprising a state in AES. This is a constant in AES. Value=4
 #define Nb 4
 
-#if defined(AES256) && (AES256 == 1)
-    #define Nk 8
-    #define Nr 14
-#elif defined(AES192) && (AES192 == 1)
-    #define Nk 6
-    #define Nr 12
-#else
-    #define Nk 4        // The number of 32 bit words in a key.
-    #define Nr 10       // The number of rounds in AES Cipher.
-#endif
+// The steps of a round are forced inline, so that each unrolled round becomes
+// straight-line code with constant round key offsets.
+#define ROUND_STEP static inline __attribute__((always_inline))
 
 // jcallan@github points out that declaring Multiply as a function
 // reduces code size considerably with the Keil ARM compiler.
@@ -149,6 +143,7 @@ static uint8_t getSBoxInvert(uint8_t num)
 #define getSBoxInvert(num) (rsbox[(num)])
 
 // This function produces Nb(Nr+1) round keys. The round keys are used in each round to decrypt the states.
+template <int Nk, int Nr>
 static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
 {
   unsigned i, j, k;
@@ -202,8 +197,7 @@ static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
 
       tempa[0] = tempa[0] ^ Rcon[i/Nk];
     }
-#if defined(AES256) && (AES256 == 1)
-    if (i % Nk == 4)
+    if (Nk == 8 && i % Nk == 4)   // AES-256 only
     {
       // Function Subword()
       {
@@ -213,7 +207,6 @@ static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
         tempa[3] = getSBoxValue(tempa[3]);
       }
     }
-#endif
     j = i * 4; k=(i - Nk) * 4;
     RoundKey[j + 0] = RoundKey[k + 0] ^ tempa[0];
     RoundKey[j + 1] = RoundKey[k + 1] ^ tempa[1];
@@ -222,27 +215,31 @@ static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
   }
 }
 
-AES::AES(){
+template <int KeyBits>
+AES<KeyBits>::AES(){
 }
 
-void AES::AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key){
-  KeyExpansion(ctx->RoundKey, key);
+template <int KeyBits>
+void AES<KeyBits>::AES_init_ctx(AES_ctx* ctx, const uint8_t* key){
+  KeyExpansion<Nk, Nr>(ctx->RoundKey, key);
 }
 #if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1))
 
-void AES::AES_init_ctx_iv(struct AES_ctx* ctx, const uint8_t* key, const uint8_t* iv){
-  KeyExpansion(ctx->RoundKey, key);
+template <int KeyBits>
+void AES<KeyBits>::AES_init_ctx_iv(AES_ctx* ctx, const uint8_t* key, const uint8_t* iv){
+  KeyExpansion<Nk, Nr>(ctx->RoundKey, key);
   memcpy (ctx->Iv, iv, AES_BLOCKLEN);
 }
 
-void AES::AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv){
+template <int KeyBits>
+void AES<KeyBits>::AES_ctx_set_iv(AES_ctx* ctx, const uint8_t* iv){
   memcpy (ctx->Iv, iv, AES_BLOCKLEN);
 }
 #endif
 
 // This function adds the round key to state.
 // The round key is added to the state by an XOR function.
-static void AddRoundKey(uint8_t round,state_t* state,uint8_t* RoundKey)
+ROUND_STEP void AddRoundKey(uint8_t round,state_t* state,uint8_t* RoundKey)
 {
   uint8_t i,j;
   for (i = 0; i < 4; ++i)
@@ -256,7 +253,7 @@ static void AddRoundKey(uint8_t round,state_t* state,uint8_t* RoundKey)
 
 // The SubBytes Function Substitutes the values in the
 // state matrix with values in an S-box.
-static void SubBytes(state_t* state)
+ROUND_STEP void SubBytes(state_t* state)
 {
   uint8_t i, j;
   for (i = 0; i < 4; ++i)
@@ -271,7 +268,7 @@ static void SubBytes(state_t* state)
 // The ShiftRows() function shifts the rows in the state to the left.
 // Each row is shifted with different offset.
 // Offset = Row number. So the first row is not shifted.
-static void ShiftRows(state_t* state)
+ROUND_STEP void ShiftRows(state_t* state)
 {
   uint8_t temp;
 
@@ -299,13 +296,13 @@ static void ShiftRows(state_t* state)
   (*state)[1][3] = temp;
 }
 
-static uint8_t xtime(uint8_t x)
+ROUND_STEP uint8_t xtime(uint8_t x)
 {
   return ((x<<1) ^ (((x>>7) & 1) * 0x1b));
 }
 
 // MixColumns function mixes the columns of the state matrix
-static void MixColumns(state_t* state)
+ROUND_STEP void MixColumns(state_t* state)
 {
   uint8_t i;
   uint8_t Tmp, Tm, t;
@@ -346,7 +343,7 @@ static uint8_t Multiply(uint8_t x, uint8_t y)
 // MixColumns function mixes the columns of the state matrix.
 // The method used to multiply may be difficult to understand for the inexperienced.
 // Please use the references to gain more information.
-static void InvMixColumns(state_t* state)
+ROUND_STEP void InvMixColumns(state_t* state)
 {
   int i;
   uint8_t a, b, c, d;
@@ -367,7 +364,7 @@ static void InvMixColumns(state_t* state)
 
 // The SubBytes Function Substitutes the values in the
 // state matrix with values in an S-box.
-static void InvSubBytes(state_t* state)
+ROUND_STEP void InvSubBytes(state_t* state)
 {
   uint8_t i, j;
   for (i = 0; i < 4; ++i)
@@ -379,7 +376,7 @@ static void InvSubBytes(state_t* state)
   }
 }
 
-static void InvShiftRows(state_t* state)
+ROUND_STEP void InvShiftRows(state_t* state)
 {
   uint8_t temp;
 
@@ -408,55 +405,94 @@ static void InvShiftRows(state_t* state)
 }
 
 
+// Rounds<Round, Nr> runs the identical rounds Round..Nr-1 of the cipher, one
+// template per round, so that the loop over the rounds is fully unrolled.
+template <int Round, int Nr>
+struct Rounds
+{
+  ROUND_STEP void Cipher(state_t* state, uint8_t* RoundKey)
+  {
+    SubBytes(state);
+    ShiftRows(state);
+    MixColumns(state);
+    AddRoundKey(Round, state, RoundKey);
+    Rounds<Round + 1, Nr>::Cipher(state, RoundKey);
+  }
+};
+
+template <int Nr>
+struct Rounds<Nr, Nr>
+{
+  ROUND_STEP void Cipher(state_t*, uint8_t*) {}
+};
+
+// InvRounds<Round> runs the identical rounds Round..1 of the inverse cipher.
+template <int Round>
+struct InvRounds
+{
+  ROUND_STEP void InvCipher(state_t* state, uint8_t* RoundKey)
+  {
+    InvShiftRows(state);
+    InvSubBytes(state);
+    AddRoundKey(Round, state, RoundKey);
+    InvMixColumns(state);
+    InvRounds<Round - 1>::InvCipher(state, RoundKey);
+  }
+};
+
+template <>
+struct InvRounds<0>
+{
+  ROUND_STEP void InvCipher(state_t*, uint8_t*) {}
+};
+
 // Cipher is the main function that encrypts the PlainText.
-static void Cipher(state_t* state, uint8_t* RoundKey)
+// The rounds work on a local copy of the block: the buffer may alias the round
+// keys, which would force every step back to memory.
+template <int Nr>
+static void Cipher(state_t* block, uint8_t* RoundKey)
 {
-  uint8_t round = 0;
+  state_t local;
+  state_t* state = &local;
+  memcpy(local, block, sizeof(local));
 
   // Add the First round key to the state before starting the rounds.
   AddRoundKey(0, state, RoundKey);
 
   // There will be Nr rounds.
   // The first Nr-1 rounds are identical.
-  // These Nr-1 rounds are executed in the loop below.
-  for (round = 1; round < Nr; ++round)
-  {
-    SubBytes(state);
-    ShiftRows(state);
-    MixColumns(state);
-    AddRoundKey(round, state, RoundKey);
-  }
+  Rounds<1, Nr>::Cipher(state, RoundKey);
 
   // The last round is given below.
   // The MixColumns function is not here in the last round.
   SubBytes(state);
   ShiftRows(state);
   AddRoundKey(Nr, state, RoundKey);
+
+  memcpy(block, local, sizeof(local));
 }
 
-static void InvCipher(state_t* state,uint8_t* RoundKey)
+template <int Nr>
+static void InvCipher(state_t* block,uint8_t* RoundKey)
 {
-  uint8_t round = 0;
+  state_t local;
+  state_t* state = &local;
+  memcpy(local, block, sizeof(local));
 
   // Add the First round key to the state before starting the rounds.
   AddRoundKey(Nr, state, RoundKey);
 
   // There will be Nr rounds.
   // The first Nr-1 rounds are identical.
-  // These Nr-1 rounds are executed in the loop below.
-  for (round = (Nr - 1); round > 0; --round)
-  {
-    InvShiftRows(state);
-    InvSubBytes(state);
-    AddRoundKey(round, state, RoundKey);
-    InvMixColumns(state);
-  }
+  InvRounds<Nr - 1>::InvCipher(state, RoundKey);
 
   // The last round is given below.
   // The MixColumns function is not here in the last round.
   InvShiftRows(state);
   InvSubBytes(state);
   AddRoundKey(0, state, RoundKey);
+
+  memcpy(block, local, sizeof(local));
 }
 
 
@@ -466,16 +502,18 @@ static void InvCipher(state_t* state,uint8_t* RoundKey)
 #if defined(ECB) && (ECB == 1)
 
 
-void AES::AES_ECB_encrypt(struct AES_ctx *ctx,const uint8_t* buf)
+template <int KeyBits>
+void AES<KeyBits>::AES_ECB_encrypt(AES_ctx *ctx,const uint8_t* buf)
 {
   // The next function call encrypts the PlainText with the Key using AES algorithm.
-  Cipher((state_t*)buf, ctx->RoundKey);
+  Cipher<Nr>((state_t*)buf, ctx->RoundKey);
 }
 
-void AES_ECB_decrypt(struct AES_ctx* ctx,const uint8_t* buf)
+template <int KeyBits>
+void AES<KeyBits>::AES_ECB_decrypt(AES_ctx* ctx,const uint8_t* buf)
 {
   // The next function call decrypts the PlainText with the Key using AES algorithm.
-  InvCipher((state_t*)buf, ctx->RoundKey);
+  InvCipher<Nr>((state_t*)buf, ctx->RoundKey);
 }
 
 
@@ -497,14 +535,15 @@ static void XorWithIv(uint8_t* buf, uint8_t* Iv)
   }
 }
 
-void AES::AES_CBC_encrypt_buffer(struct AES_ctx *ctx,uint8_t* buf, uint32_t length)
+template <int KeyBits>
+void AES<KeyBits>::AES_CBC_encrypt_buffer(AES_ctx *ctx,uint8_t* buf, uint32_t length)
 {
   uintptr_t i;
   uint8_t *Iv = ctx->Iv;
   for (i = 0; i < length; i += AES_BLOCKLEN)
   {
     XorWithIv(buf, Iv);
-    Cipher((state_t*)buf, ctx->RoundKey);
+    Cipher<Nr>((state_t*)buf, ctx->RoundKey);
     Iv = buf;
     buf += AES_BLOCKLEN;
     //printf("Step %d - %d", i/16, i);
@@ -513,14 +552,15 @@ void AES::AES_CBC_encrypt_buffer(struct AES_ctx *ctx,uint8_t* buf, uint32_t leng
   memcpy(ctx->Iv, Iv, AES_BLOCKLEN);
 }
 
-void AES::AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf,  uint32_t length)
+template <int KeyBits>
+void AES<KeyBits>::AES_CBC_decrypt_buffer(AES_ctx* ctx, uint8_t* buf,  uint32_t length)
 {
   uintptr_t i;
   uint8_t storeNextIv[AES_BLOCKLEN];
   for (i = 0; i < length; i += AES_BLOCKLEN)
   {
     memcpy(storeNextIv, buf, AES_BLOCKLEN);
-    InvCipher((state_t*)buf, ctx->RoundKey);
+    InvCipher<Nr>((state_t*)buf, ctx->RoundKey);
     XorWithIv(buf, ctx->Iv);
     memcpy(ctx->Iv, storeNextIv, AES_BLOCKLEN);
     buf += AES_BLOCKLEN;
@@ -535,7 +575,8 @@ void AES::AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf,  uint32_t le
 #if defined(CTR) && (CTR == 1)
 
 /* Symmetrical operation: same function for encrypting as for decrypting. Note any IV/nonce should never be reused with the same key */
-void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length)
+template <int KeyBits>
+void AES<KeyBits>::AES_CTR_xcrypt_buffer(AES_ctx* ctx, uint8_t* buf, uint32_t length)
 {
   uint8_t buffer[AES_BLOCKLEN];
 
@@ -547,7 +588,7 @@ void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length)
     {
 
       memcpy(buffer, ctx->Iv, AES_BLOCKLEN);
-      Cipher((state_t*)buffer,ctx->RoundKey);
+      Cipher<Nr>((state_t*)buffer,ctx->RoundKey);
 
       /* Increment Iv and handle overflow */
       for (bi = (AES_BLOCKLEN - 1); bi >= 0; --bi)
@@ -569,3 +610,9 @@ void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length)
 }
 
 #endif // #if defined(CTR) && (CTR == 1)
+
+
+
+template class AES<128>;
+template class AES<192>;
+template class AES<256>;
@@ -23,54 +23,52 @@
 #endif
 
 
-#define AES128 1
-//#define AES192 1
-//#define AES256 1
-
 #define AES_BLOCKLEN 16 //Block length in bytes AES is 128b block only
 
-#if defined(AES256) && (AES256 == 1)
-    #define AES_KEYLEN 32
-    #define AES_keyExpSize 240
-#elif defined(AES192) && (AES192 == 1)
-    #define AES_KEYLEN 24
-    #define AES_keyExpSize 208
-#else
-    #define AES_KEYLEN 16   // Key length in bytes
-    #define AES_keyExpSize 176
-#endif
+// The key size is the template argument: AES<128>, AES<192> and AES<256> can be
+// used side by side, and each one gets its own fully unrolled rounds.
+template <int KeyBits>
+class AES {
+    static_assert(KeyBits == 128 || KeyBits == 192 || KeyBits == 256, "AES keys have 128, 192 or 256 bits");
 
-struct AES_ctx{
-      uint8_t RoundKey[AES_keyExpSize];
-      uint8_t Iv[AES_BLOCKLEN];
-};
+	public:
+		static const int KEYLEN = KeyBits / 8;                    // Key length in bytes
+		static const int Nk = KeyBits / 32;                       // The number of 32 bit words in a key.
+		static const int Nr = Nk + 6;                             // The number of rounds in AES Cipher.
+		static const int keyExpSize = AES_BLOCKLEN * (Nr + 1);    // 176, 208 or 240 bytes of round keys.
 
+		struct AES_ctx{
+		      uint8_t RoundKey[keyExpSize];
+		      uint8_t Iv[AES_BLOCKLEN];
+		};
 
-class AES {
-  
-	public:
 		AES();
 
-		void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key);
-		void AES_init_ctx_iv(struct AES_ctx* ctx, const uint8_t* key, const uint8_t* iv);
-		void AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv);
+		void AES_init_ctx(AES_ctx* ctx, const uint8_t* key);
+		void AES_init_ctx_iv(AES_ctx* ctx, const uint8_t* key, const uint8_t* iv);
+		void AES_ctx_set_iv(AES_ctx* ctx, const uint8_t* iv);
 
 		// buffer size MUST be mutile of AES_BLOCKLEN;
 		// Suggest https://en.wikipedia.org/wiki/Padding_(cryptography)#PKCS7 for padding scheme
 		// NOTES: you need to set IV in ctx via AES_init_ctx_iv() or AES_ctx_set_iv()
 		//        no IV should ever be reused with the same key
-		void AES_CBC_encrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length);
-		void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length);
-    void AES_ECB_encrypt(struct AES_ctx *ctx,const uint8_t* buf);
+		void AES_CBC_encrypt_buffer(AES_ctx* ctx, uint8_t* buf, uint32_t length);
+		void AES_CBC_decrypt_buffer(AES_ctx* ctx, uint8_t* buf, uint32_t length);
+    void AES_ECB_encrypt(AES_ctx *ctx,const uint8_t* buf);
+    void AES_ECB_decrypt(AES_ctx *ctx,const uint8_t* buf);
 
 		// Same function for encrypting as for decrypting.
 		// IV is incremented for every block, and used after encryption as XOR-compliment for output
 		// Suggesting https://en.wikipedia.org/wiki/Padding_(cryptography)#PKCS7 for padding scheme
 		// NOTES: you need to set IV in ctx with AES_init_ctx_iv() or AES_ctx_set_iv()
 		//        no IV should ever be reused with the same key
-		void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length);
+		void AES_CTR_xcrypt_buffer(AES_ctx* ctx, uint8_t* buf, uint32_t length);
     private:
 
 };
 
+typedef AES<128> AES128;
+typedef AES<192> AES192;
+typedef AES<256> AES256;
+
 #endif //_AES_H_
@@ -0,0 +1,85 @@
+#include "Admission.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "../time.h"
+
+namespace admission
+{
+
+/* Entradas examinadas por busca; sem o endereço entre elas, a mais ociosa é substituída. */
+#define PROBES 8
+
+typedef struct bucket
+{
+    uint32_t peer;
+    float tokens;
+    uint64_t last;      /* nanoTime() da última ficha; 0 indica entrada livre. */
+} Bucket;
+
+static std::mutex lock;
+static Bucket buckets[ADMISSION_SOURCES];
+static std::atomic<int> inProgress(0);
+
+static uint32_t slot(uint32_t peer)
+{
+    /* Hash multiplicativo: endereços vizinhos caem longe uns dos outros. */
+    return (uint32_t)(peer * 2654435761u) % ADMISSION_SOURCES;
+}
+
+/* Balde do endereço, criado cheio se ainda não existir. Chamado com o lock. */
+static Bucket &find(uint32_t peer, uint64_t now)
+{
+    const uint32_t first = slot(peer);
+
+    Bucket *idle = &buckets[first];
+    for (int i = 0; i < PROBES; i++)
+    {
+        Bucket &b = buckets[(first + i) % ADMISSION_SOURCES];
+        if (b.last != 0 && b.peer == peer)
+            return b;
+        if (b.last < idle->last)
+            idle = &b;
+    }
+
+    idle->peer = peer;
+    idle->tokens = ADMISSION_BURST;
+    idle->last = now;
+    return *idle;
+}
+
+bool admit(uint32_t peer)
+{
+    const uint64_t now = nanoTime();
+
+    std::lock_guard<std::mutex> guard(lock);
+    Bucket &b = find(peer, now);
+
+    b.tokens += (now - b.last) / 1e9 * ADMISSION_RATE;
+    if (b.tokens > ADMISSION_BURST)
+        b.tokens = ADMISSION_BURST;
+    b.last = now;
+
+    if (b.tokens < 1)
+        return false;
+
+    b.tokens -= 1;
+    return true;
+}
+
+bool begin()
+{
+    if (inProgress.fetch_add(1, std::memory_order_acquire) < ADMISSION_HANDSHAKES)
+        return true;
+
+    inProgress.fetch_sub(1, std::memory_order_release);
+    return false;
+}
+
+void end()
+{
+    inProgress.fetch_sub(1, std::memory_order_release);
+}
+
+}
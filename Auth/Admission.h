@@ -0,0 +1,30 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stdint.h>
+
+#include "../settings.h"
+
+/*  Controle de admissão do Servidor, antes de qualquer trabalho criptográfico.
+    Cada SYN e cada RSA consomem uma ficha do balde do endereço de origem
+    (ADMISSION_RATE fichas por segundo, até ADMISSION_BURST), guardado em
+    uma tabela compacta de ADMISSION_SOURCES entradas. Além disso, no máximo
+    ADMISSION_HANDSHAKES handshakes passam do Step 3 ao mesmo tempo. O que
+    não é admitido é descartado em silêncio; as sessões já estabelecidas não
+    passam por aqui. Global ao processo.
+*/
+namespace admission
+{
+
+/*  Consome uma ficha do endereço (IPv4, ordem do host). */
+bool admit(uint32_t peer);
+
+/*  Reserva uma vaga para um handshake em andamento. */
+bool begin();
+
+/*  Libera a vaga reservada por begin(). */
+void end();
+
+}
+
+#endif
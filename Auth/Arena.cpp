@@ -0,0 +1,92 @@
+#include "Arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+Arena::Arena()
+{
+}
+
+Arena::~Arena()
+{
+    while (blocks != NULL)
+    {
+        Block *next = blocks->next;
+        free(blocks);
+        blocks = next;
+    }
+}
+
+
+
+
+/*  Reserva 'bytes' bytes alinhados; a memória vale até o próximo reset(). */
+void *Arena::allocate(size_t bytes, size_t align)
+{
+    if (blocks != NULL)
+    {
+        const uintptr_t base = (uintptr_t)data(blocks);
+        const uintptr_t start = (base + used + align - 1) & ~(uintptr_t)(align - 1);
+
+        if (start + bytes <= base + blocks->size)
+        {
+            used = start + bytes - base;
+            return (void *)start;
+        }
+    }
+
+    grow(bytes + align);
+    return allocate(bytes, align);
+}
+
+
+
+
+/*  Libera todas as alocações de uma vez. */
+void Arena::reset()
+{
+    used = 0;
+    if (blocks == NULL || blocks->next == NULL)
+        return;
+
+    /* A sessão transbordou o bloco: um único bloco do tamanho somado atende às próximas. */
+    const size_t size = total;
+    while (blocks != NULL)
+    {
+        Block *next = blocks->next;
+        free(blocks);
+        blocks = next;
+    }
+    total = 0;
+    grow(size);
+}
+
+
+
+
+/*  Abre um bloco novo com pelo menos 'bytes' bytes livres. */
+void Arena::grow(size_t bytes)
+{
+    size_t size = blocks == NULL ? ARENA_SIZE : blocks->size * 2;
+    if (size < bytes)
+        size = bytes;
+
+    Block *block = (Block *)malloc(sizeof(Block) + size);
+    if (block == NULL)
+        throw std::bad_alloc();
+
+    block->next = blocks;
+    block->size = size;
+    blocks = block;
+    used = 0;
+    total += size;
+}
+
+
+
+
+/*  Início da área útil do bloco, logo após o cabeçalho. */
+char *Arena::data(Block *block)
+{
+    return (char *)block + sizeof(Block);
+}
@@ -0,0 +1,64 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+
+#include "../settings.h"
+
+/*  Arena de alocação de uma sessão.
+    As alocações do handshake (buffers do RSA, storages) apenas avançam um
+    ponteiro dentro de um bloco, e reset() devolve tudo de uma vez quando a
+    sessão termina. O primeiro bloco, de ARENA_SIZE bytes, é criado no
+    primeiro uso e reaproveitado pelas sessões seguintes; se um handshake
+    precisar de mais, os blocos extras são fundidos em um só no reset(), e
+    a partir daí a sessão não volta a tocar no alocador.
+*/
+class Arena
+{
+  public:
+    Arena();
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /*  Reserva 'bytes' bytes alinhados; a memória vale até o próximo reset(). */
+    void *allocate(size_t bytes, size_t align = alignof(max_align_t));
+
+    /*  Vetor de 'count' elementos, não inicializado. */
+    template <typename T>
+    T *array(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "reset() não chama destrutores");
+        return (T *)allocate(count * sizeof(T), alignof(T));
+    }
+
+    /*  Objeto construído na arena. */
+    template <typename T>
+    T *make()
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "reset() não chama destrutores");
+        return new (allocate(sizeof(T), alignof(T))) T();
+    }
+
+    /*  Libera todas as alocações de uma vez. */
+    void reset();
+
+  private:
+    typedef struct block
+    {
+        struct block *next;
+        size_t size;
+    } Block;
+
+    Block *blocks = NULL;   /* O bloco atual é o primeiro da lista. */
+    size_t used = 0;        /* Bytes ocupados no bloco atual. */
+    size_t total = 0;       /* Bytes de todos os blocos. */
+
+    void grow(size_t bytes);
+    static char *data(Block *block);
+};
+
+#endif
@@ -1,9 +1,19 @@
 #include "AuthClient.h"
 
-AuthClient::AuthClient()
+using namespace client_verbose;
+
+template <typename Policy>
+BasicAuthClient<Policy>::BasicAuthClient() : BasicAuthClient(&udpSocket)
+{
+}
+
+
+
+
+/*  Utiliza o transporte informado no lugar do socket UDP padrão. */
+template <typename Policy>
+BasicAuthClient<Policy>::BasicAuthClient(Transport *transport) : soc(transport)
 {
-    nonceA[128] = '\0';
-    nonceB[128] = '\0';
     memset(envia, 0, sizeof(envia));
     memset(recebe, 0, sizeof(recebe));
 }
@@ -12,12 +22,19 @@ AuthClient::AuthClient()
 
 
 /*  Inicia conexão com o Servidor. */
-int AuthClient::connect(char *address, int port)
+template <typename Policy>
+int BasicAuthClient<Policy>::connect(char *address, int port)
 {
-    soc.connect(address, port);
-    soc.max_response_time(TIMEOUT_SEC, TIMEOUT_MIC);
-    serverIP = soc.server_address();
-    clientIP = soc.client_address();
+    session = trace::newSession();
+    markStep(0);
+
+    /* A sessão anterior já terminou: sua memória é devolvida de uma vez. */
+    release();
+
+    soc->connect(address, port);
+    soc->max_response_time(Policy::timeoutSec, Policy::timeoutMic);
+    serverIP = soc->server_address();
+    clientIP = soc->client_address();
 
     try
     {
@@ -25,11 +42,14 @@ int AuthClient::connect(char *address, int port)
     }
     catch (status e)
     {
-        reply_verbose(e);
+        if (Policy::verbose)
+            reply_verbose(e);
+        if (Policy::trace)
+            trace::record(trace::CLIENT, trace::FAIL, session, e);
         return e;
     }
 
-    delete rsaStorage;
+    rsaStorage = NULL;
     return OK;
 }
 
@@ -37,109 +57,156 @@ int AuthClient::connect(char *address, int port)
 
 
 /*  Entra em estado de espera por dados vindos do Servidor. */
-string AuthClient::listen()
+template <typename Policy>
+string BasicAuthClient<Policy>::listen()
 {
-    if (isConnected())
-    {
-        /********************* Recebimento dos Dados Cifrados *********************/
-        char message[1333];
-        memset(message, '\0', sizeof(message));
-        int recv = 0;
+    Received message = receive();
+    if (message.data == NULL)
+        return "";
 
-        while (recv <= 0)
-        {
-            recv = soc.recv(message, sizeof(message) - 1);
-        }
+    const string result(message.data, strnlen(message.data, message.size));
+    release(message);
+    return result;
+}
 
-        if (isDisconnectRequest(message))
-        {
-            rdisconnect();
-        }
-        else
-        {
-            /**************** RECEBE A MENSAGEM *****************************************/
-            /* Converte o array de chars (buffer) em uma string. */
-            string encryptedMessage(message);
-
-            /* Inicialização dos vetores ciphertext. */
-            char ciphertextChar[encryptedMessage.length()];
-            uint8_t ciphertext[encryptedMessage.length()];
-            memset(ciphertext, '\0', encryptedMessage.length());
-
-            /* Inicialização do vetor plaintext. */
-            uint8_t plaintext[encryptedMessage.length()];
-            memset(plaintext, '\0', encryptedMessage.length());
-
-            /* Inicialização da chave e iv. */
-            uint8_t key[32];
-            for (int i = 0; i < 32; i++)
-            {
-                key[i] = dhStorage->getSessionKey();
-            }
 
-            uint8_t iv[16];
-            for (int i = 0; i < 16; i++)
-            {
-                iv[i] = dhStorage->getIV();
-            }
 
-            /* Converte a mensagem recebida (HEXA) para o array de char ciphertextChar. */
-            HexStringToCharArray(&encryptedMessage, encryptedMessage.length(), ciphertextChar);
 
-            /* Converte ciphertextChar em um array de uint8_t (ciphertext). */
-            CharToUint8_t(ciphertextChar, ciphertext, encryptedMessage.length());
+/*  Recebe uma mensagem do Servidor e a decifra no próprio buffer do
+    datagrama, sem cópias intermediárias. O conteúdo vale até release();
+    data é NULL se o Servidor encerrou a conexão ou a mensagem era inválida.
+*/
+template <typename Policy>
+Received BasicAuthClient<Policy>::receive()
+{
+    Received message = {NULL, 0, NULL};
+    if (!isConnected())
+        return message;
 
-            /* Decifra a mensagem em um vetor de uint8_t. */
-            uint8_t *decrypted = iotAuth.decryptAES(ciphertext, key, iv, encryptedMessage.length());
-            // cout << "Decrypted: " << decrypted << endl << endl;
+    /********************* Recebimento dos Dados Cifrados *********************/
+    Datagram *const datagram = datagrams.acquire();
+    int recv = 0;
 
-            /************************** ENVIA ACK CONFIRMANDO ********************************/
-            while (sack() == false);
+    while (recv <= 0)
+    {
+        recv = soc->recv(datagram->bytes, sizeof(datagram->bytes) - 1);
+    }
+    datagram->bytes[recv] = '\0';
 
-            return Uint8_tToString(decrypted, encryptedMessage.length());
-        }
+    if (isDisconnectRequest(datagram->bytes))
+    {
+        datagrams.release(datagram);
+        rdisconnect();
+        return message;
     }
+
+    /**************** Decifra no Buffer do Datagrama ****************/
+    /* Hexadecimal para bytes e, em seguida, AES no mesmo lugar; só blocos inteiros são decifrados. */
+    const int size = HexStringToBytesInPlace((char *)datagram->bytes, recv) / AES_BLOCKLEN * AES_BLOCKLEN;
+    if (size <= 0)
+    {
+        datagrams.release(datagram);
+        return message;
+    }
+
+    uint8_t key[AES<Policy::aesKeyBits>::KEYLEN];
+    memset(key, dhStorage->getSessionKey(), sizeof(key));
+
+    uint8_t iv[16];
+    memset(iv, dhStorage->getIV(), sizeof(iv));
+
+    iotAuth.decryptAES<Policy::aesKeyBits>(datagram->bytes, key, iv, size);
+    datagram->size = size;
+
+    /************************** ENVIA ACK CONFIRMANDO ********************************/
+    while (sack() == false);
+
+    if (Policy::trace)
+        trace::record(trace::CLIENT, trace::RECEIVE, session, OK);
+
+    message.data = (const char *)datagram->bytes;
+    message.size = size;
+    message.datagram = datagram;
+    return message;
+}
+
+
+
+
+/*  Devolve ao pool o datagrama de uma mensagem recebida. */
+template <typename Policy>
+void BasicAuthClient<Policy>::release(Received &message)
+{
+    datagrams.release(message.datagram);
+    message.data = NULL;
+    message.datagram = NULL;
 }
 
 
 
 
 /*  Envia dados para o Servidor. */
-int AuthClient::publish(char *data)
+template <typename Policy>
+int BasicAuthClient<Policy>::publish(char *data)
+{
+    /* Texto: nada depois do terminador é lido, mas a mensagem mantém MAX_PAYLOAD bytes. */
+    return publishMessage(data, strnlen(data, MAX_PAYLOAD), MAX_PAYLOAD);
+}
+
+
+
+
+/*  Envia os primeiros 'size' bytes de dados para o Servidor (até MAX_PAYLOAD). */
+template <typename Policy>
+int BasicAuthClient<Policy>::publish(char *data, int size)
+{
+    if (size > MAX_PAYLOAD)
+        size = MAX_PAYLOAD;
+    return publishMessage(data, size, size);
+}
+
+
+
+
+/*  Cifra os 'length' primeiros bytes de dados em uma mensagem de 'size'
+    bytes e a envia ao Servidor. A mensagem é montada em um datagrama da
+    sessão: nada é alocado nem copiado no caminho.
+*/
+template <typename Policy>
+int BasicAuthClient<Policy>::publishMessage(const char *data, int length, int size)
 {
     if (isConnected()) {
-        string encrypted = encryptMessage(data, 666);
+        Datagram *const datagram = datagrams.acquire();
+        const int bytes = encryptMessage(data, length, size, datagram);
 
-        // cout << "Encrypted Message: " << encrypted << endl;
-        
-        int sent = soc.send(encrypted.c_str(), encrypted.length());
+        int sent = soc->send(datagram->bytes, bytes);
+        datagrams.release(datagram);
 
-        if (sent > 0)
-        {
-            if (rack())
-            {
-                return OK;
-            }
-            return DENIED;
-        }
-        else
-            return DENIED;
+        const status result = sent > 0 && rack() ? OK : DENIED;
+
+        if (Policy::trace)
+            trace::record(trace::CLIENT, trace::PUBLISH, session, result);
+
+        return result;
     } else {
         cout << "Não existe conexão com o servidor!" << endl;
         return NOT_CONNECTED;
     }
-    return DENIED;
 }
 
 
 
 
 /*  Envia um pedido de término de conexão ao Servidor. */
-status AuthClient::disconnect()
+template <typename Policy>
+status BasicAuthClient<Policy>::disconnect()
 {
     if (isConnected())
     {
-        return done();
+        const status result = done();
+        if (Policy::trace)
+            trace::record(trace::CLIENT, trace::DISCONNECT, session, result);
+        return result;
     }
     else
     {
@@ -152,7 +219,8 @@ status AuthClient::disconnect()
 
 
 /*  Retorna um boolean para indicar se possui conexão com o Servidor. */
-bool AuthClient::isConnected()
+template <typename Policy>
+bool BasicAuthClient<Policy>::isConnected()
 {
     return connected;
 }
@@ -160,45 +228,128 @@ bool AuthClient::isConnected()
 
 
 
+/*  Retorna os instantes (currentTime) em que cada passo do último handshake
+    foi concluído. O índice 0 marca o início do connect() e o índice i o fim
+    do Step i.
+*/
+template <typename Policy>
+const double *BasicAuthClient<Policy>::stepTimes()
+{
+    return stepTime;
+}
+
+
+
+
+/*  Descarta o ticket da última sessão; o próximo connect() faz o
+    handshake completo.
+*/
+template <typename Policy>
+void BasicAuthClient<Policy>::forgetSession()
+{
+    ticket.keyId = 0;
+}
+
+
+
+
+/*  Registra o fim do Step informado (0 para o início do handshake)
+    em stepTime e no trace.
+*/
+template <typename Policy>
+void BasicAuthClient<Policy>::markStep(int step)
+{
+    stepTime[step] = currentTime();
+
+    if (Policy::trace)
+        trace::record(trace::CLIENT, step, session, OK);
+}
+
+
+
+
 /*  Step 1
     Envia pedido de início de conexão ao Servidor.   
 */
-void AuthClient::send_syn()
+template <typename Policy>
+void BasicAuthClient<Policy>::send_syn()
 {
     /******************** Init Sequence ********************/
     sequence = iotAuth.randomNumber(9999);
 
     /******************** Generate Nonce ********************/
-    generateNonce(nonceA);
-
-    /******************** Mount SYN Package ********************/
-    structSyn toSend;
-    strncpy(toSend.nonce, nonceA, sizeof(toSend.nonce));
+    generateNonce(&nonceA);
 
     /******************** Start Network Time ********************/
     t1 = currentTime();
 
-    /******************** Send SYN ********************/
-    soc.send((syn *)&toSend, sizeof(syn));
+    if (Policy::tickets && ticket.keyId != 0)
+    {
+        /******************** Mount Resume Package ********************/
+        structResume toSend;
+        toSend.nonce = nonceA;
+        toSend.ticket = ticket;
+        tickets::proof(ticketKey, ticketIV, nonceA, Nonce(), toSend.proof);
+
+        /******************** Send SYN ********************/
+        byte datagram[wire::size<structResume>()];
+        wire::encode(toSend, datagram);
+        soc->send(datagram, sizeof(datagram));
+    }
+    else
+    {
+        /******************** Mount SYN Package ********************/
+        structSyn toSend;
+        toSend.nonce = nonceA;
+
+        /******************** Send SYN ********************/
+        byte datagram[wire::size<structSyn>()];
+        wire::encode(toSend, datagram);
+        soc->send(datagram, sizeof(datagram));
+    }
 
     /******************** Verbose ********************/
-    if (VERBOSE)
+    if (Policy::verbose)
         send_syn_verbose(nonceA);
 
+    /******************** Step Time ********************/
+    markStep(1);
+
     recv_ack();
 }
 
 /*  Step 2
     Recebe confirmação do Servidor referente ao pedido de início de conexão.    
 */
-void AuthClient::recv_ack()
+template <typename Policy>
+void BasicAuthClient<Policy>::recv_ack()
 {
     /******************** Receive ACK ********************/
-    structAck received;
-    int recv = soc.recv(&received, sizeof(ack));
+    /* Uma retomada aceita começa como um ACK comum; o tamanho recebido os diferencia. */
+    static_assert(wire::size<structAck>() < wire::size<structResumeAck>(), "ACK and resume ACK must differ in size on the wire");
+    byte datagram[wire::size<structResumeAck>()];
+    int recv = soc->recv(datagram, sizeof(datagram));
+
+    if (recv == wire::size<structResumeAck>() && Policy::tickets)
+    {
+        structResumeAck received;
+        wire::decode(datagram, received);
+        recv_resume_ack(&received);
+        return;
+    }
+
+    /* Um ACK comum após um ticket: o Servidor o recusou e segue com o handshake completo. */
+    if (recv > 0)
+        forgetSession();
+
+    if (recv > 0 && recv != wire::size<structAck>())
+        throw DENIED;
 
     if (recv > 0)
     {
+        structAck ack;
+        wire::decode(datagram, ack);
+
         /******************** Stop Network Time ********************/
         t2 = currentTime();
         networkTime = elapsedTime(t1, t2);
@@ -207,17 +358,20 @@ void AuthClient::recv_ack()
         t1 = currentTime();
 
         /******************** Store Nonce B ********************/
-        storeNonceB(received.nonceB);
+        storeNonceB(ack.nonceB);
 
         /******************** Validity Message ********************/
-        const bool isNonceTrue = (strcmp(received.nonceA, nonceA) == 0);
+        const bool isNonceTrue = ack.nonceA == nonceA;
 
         /******************** Verbose ********************/
-        if (VERBOSE)
+        if (Policy::verbose)
             recv_ack_verbose(nonceB, sequence, serverIP, clientIP, isNonceTrue);
 
         if (isNonceTrue)
         {
+            /******************** Step Time ********************/
+            markStep(2);
+
             send_rsa();
         }
         else
@@ -227,26 +381,75 @@ void AuthClient::recv_ack()
     }
     else
     {
-        if (VERBOSE)
+        if (Policy::verbose)
             response_timeout_verbose();
         throw NO_REPLY;
     }
 }
 
+/*  Resume
+    Conclui a retomada aceita pelo Servidor, no lugar dos Steps 3 a 8.
+*/
+template <typename Policy>
+void BasicAuthClient<Policy>::recv_resume_ack(structResumeAck *received)
+{
+    /******************** Store Nonce B ********************/
+    storeNonceB(received->nonceB);
+
+    /******************** Derive Session Key ********************/
+    int sessionKey = ticketKey;
+    int iv = ticketIV;
+    tickets::derive(&sessionKey, &iv, nonceA, nonceB);
+
+    /******************** Validity ********************/
+    const bool isNonceTrue = received->nonceA == nonceA;
+    uint8_t proof[PROOF_SIZE];
+    tickets::proof(sessionKey, iv, nonceA, nonceB, proof);
+    const bool isProofValid = constantTimeEquals(proof, received->proof, PROOF_SIZE);
+
+    if (!isNonceTrue)
+        throw NONCE_INVALID;
+    if (!isProofValid)
+    {
+        forgetSession();
+        throw HASH_INVALID;
+    }
+
+    /******************** Store Session Key ********************/
+    dhStorage = iotAuth.arena.make<DHStorage>();
+    dhStorage->setSessionKey(sessionKey);
+    dhStorage->setIV(iv);
+
+    /******************** Session Ticket ********************/
+    ticket = received->ticket;
+    ticketKey = sessionKey;
+    ticketIV = iv;
+
+    connected = true;
+
+    /******************** Step Time ********************/
+    /* Os Steps 2 a 8 terminam juntos na retomada. */
+    stepTime[2] = currentTime();
+    for (int step = 3; step <= 8; step++)
+        stepTime[step] = stepTime[2];
+
+    if (Policy::trace)
+        trace::record(trace::CLIENT, trace::RESUME, session, OK);
+}
+
 /*  Step 3
     Realiza o envio dos dados RSA para o Servidor.  
 */
-void AuthClient::send_rsa()
+template <typename Policy>
+void BasicAuthClient<Policy>::send_rsa()
 {
     /******************** Generate RSA/FDR ********************/
-    rsaStorage = new RSAStorage();
+    rsaStorage = iotAuth.arena.make<RSAStorage>();
     rsaStorage->setKeyPair(iotAuth.generateRSAKeyPair());
     rsaStorage->setMyFDR(iotAuth.generateFDR());
 
-    /******************** Generate Nonce ********************/
-    generateNonce(nonceA);
-
     /******************** Mount Package ********************/
+    /* O nonce A é o mesmo do SYN: o Servidor precisa dele para validar o cookie (nonce B). */
     RSAPackage rsaSent;
     rsaSent.setPublicKey(*rsaStorage->getMyPublicKey());
     rsaSent.setFDR(*rsaStorage->getMyFDR());
@@ -254,42 +457,43 @@ void AuthClient::send_rsa()
     rsaSent.setNonceB(nonceB);
 
     /******************** Get Hash ********************/
-    string rsaString = rsaSent.toString();
-    int *const encryptedHash = iotAuth.signedHash(&rsaString, rsaStorage->getMyPrivateKey());
+    int *const encryptedHash = iotAuth.signedHash(&rsaSent, rsaStorage->getMyPrivateKey(), Policy::verbose);
 
     /******************** Stop Processing Time ********************/
     t2 = currentTime();
     processingTime1 = elapsedTime(t1, t2);
 
-    /******************** Mount Exchange ********************/
-    RSAKeyExchange rsaExchange;
-    rsaExchange.setRSAPackage(&rsaSent);
-    rsaExchange.setEncryptedHash(encryptedHash);
-    rsaExchange.setProcessingTime(processingTime1);
+    /******************** Encode Exchange ********************/
+    /* Pacote e hash vão direto para a arena da sessão; o tempo de processamento segue à parte no envio. */
+    byte *const body = iotAuth.arena.array<byte>(wire::size<RSAKeyExchange>());
+    const size_t bodySize = RSAKeyExchange::encodeBody(rsaSent, encryptedHash, body);
 
     /******************** Start Total Time ********************/
     t1 = currentTime();
 
     /******************** Send Exchange ********************/
-    soc.send((RSAKeyExchange *)&rsaExchange, sizeof(rsaExchange));
+    sendTimed(body, bodySize, processingTime1);
 
-    delete[] encryptedHash;
 
     /******************** Verbose ********************/
-    if (VERBOSE)
+    if (Policy::verbose)
         send_rsa_verbose(rsaStorage, sequence, nonceA);
 
+    /******************** Step Time ********************/
+    markStep(3);
+
     recv_rsa();
 }
 
 /*  Step 4
     Recebe os dados RSA vindos do Servidor.
 */
-void AuthClient::recv_rsa()
+template <typename Policy>
+void BasicAuthClient<Policy>::recv_rsa()
 {
     /******************** Receive Exchange ********************/
-    RSAKeyExchange rsaKeyExchange;
-    int recv = soc.recv(&rsaKeyExchange, sizeof(RSAKeyExchange));
+    byte datagram[wire::size<RSAKeyExchange>()];
+    int recv = soc->recv(datagram, sizeof(datagram));
 
     if (recv > 0)
     {
@@ -297,9 +501,11 @@ void AuthClient::recv_rsa()
         t2 = currentTime();
         totalTime = elapsedTime(t1, t2);
 
-        if (isDisconnectRequest(rsaKeyExchange))
+        /* O Servidor recusou o handshake. */
+        if (isDisconnectRequest(datagram))
         {
             rdisconnect();
+            throw DENIED;
         }
         else
         {
@@ -309,6 +515,8 @@ void AuthClient::recv_rsa()
             if (totalTime <= 2000)
             {
                 /******************** Get Package ********************/
+                RSAKeyExchange rsaKeyExchange;
+                wire::decode(datagram, rsaKeyExchange);
                 RSAPackage *const rsaPackage = rsaKeyExchange.getRSAPackage();
 
                 /******************** Config RSA ********************/
@@ -317,19 +525,21 @@ void AuthClient::recv_rsa()
                 storeNonceB(rsaPackage->getNonceB());
 
                 /******************** Decrypt Hash ********************/
-                string rsaString = rsaPackage->toString();
-                string decryptedHash = decryptHash(rsaKeyExchange.getEncryptedHash());
+                byte *const decryptedHash = decryptHash(rsaKeyExchange.getEncryptedHash());
 
                 /******************** Validity ********************/
-                const bool isHashValid = iotAuth.isHashValid(&rsaString, &decryptedHash);
-                const bool isNonceTrue = strcmp(rsaPackage->getNonceA(), nonceA) == 0;
+                const bool isHashValid = iotAuth.isHashValid(rsaPackage, decryptedHash);
+                const bool isNonceTrue = rsaPackage->getNonceA() == nonceA;
                 const bool isAnswerCorrect = iotAuth.isAnswerCorrect(rsaStorage->getMyFDR(), rsaStorage->getMyPublicKey()->d, rsaPackage->getAnswerFDR());
 
-                if (VERBOSE)
+                if (Policy::verbose)
                     recv_rsa_verbose(rsaStorage, nonceB, isHashValid, isNonceTrue, isAnswerCorrect);
 
                 if (isHashValid && isNonceTrue && isAnswerCorrect)
                 {
+                    /******************** Step Time ********************/
+                    markStep(4);
+
                     send_rsa_ack();
                 }
                 else if (!isHashValid)
@@ -350,7 +560,7 @@ void AuthClient::recv_rsa()
             }
             else
             {
-                if (VERBOSE)
+                if (Policy::verbose)
                     time_limit_burst_verbose();
                 throw TIMEOUT;
             }
@@ -358,7 +568,7 @@ void AuthClient::recv_rsa()
     }
     else
     {
-        if (VERBOSE)
+        if (Policy::verbose)
             response_timeout_verbose();
         throw NO_REPLY;
     }
@@ -367,13 +577,14 @@ void AuthClient::recv_rsa()
 /*  Step 5
     Envia confirmação para o Servidor referente ao recebimento dos dados RSA.  
 */
-void AuthClient::send_rsa_ack()
+template <typename Policy>
+void BasicAuthClient<Policy>::send_rsa_ack()
 {
     /******************** Get Answer FDR ********************/
     const int answerFdr = rsaStorage->getPartnerFDR()->getValue(rsaStorage->getPartnerPublicKey()->d);
 
     /******************** Generate Nonce ********************/
-    generateNonce(nonceA);
+    generateNonce(&nonceA);
 
     /******************** Mount Package ********************/
     RSAPackage rsaSent;
@@ -383,37 +594,40 @@ void AuthClient::send_rsa_ack()
     rsaSent.setACK();
 
     /******************** Get Hash ********************/
-    string rsaString = rsaSent.toString();
-    int *const encryptedHash = iotAuth.signedHash(&rsaString, rsaStorage->getMyPrivateKey());
+    int *const encryptedHash = iotAuth.signedHash(&rsaSent, rsaStorage->getMyPrivateKey(), Policy::verbose);
 
-    /******************** Mount Exchange ********************/
-    RSAKeyExchange rsaExchange;
-    rsaExchange.setRSAPackage(&rsaSent);
-    rsaExchange.setEncryptedHash(encryptedHash);
+    /******************** Encode Exchange ********************/
+    /* Pacote e hash vão direto para a arena da sessão; o tempo de processamento segue à parte no envio. */
+    byte *const body = iotAuth.arena.array<byte>(wire::size<RSAKeyExchange>());
+    const size_t bodySize = RSAKeyExchange::encodeBody(rsaSent, encryptedHash, body);
 
     /******************** Start Total Time ********************/
     t1 = currentTime();
 
     /******************** Send Exchange ********************/
-    soc.send((RSAKeyExchange *)&rsaExchange, sizeof(rsaExchange));
+    /* O ACK não leva tempo de processamento. */
+    sendTimed(body, bodySize, 0);
 
-    delete[] encryptedHash;
 
     /******************** Verbose ********************/
-    if (VERBOSE)
+    if (Policy::verbose)
         send_rsa_ack_verbose(sequence, nonceA);
 
+    /******************** Step Time ********************/
+    markStep(5);
+
     recv_dh();
 }
 
 /*  Step 6
     Realiza o recebimento dos dados Diffie-Hellman vinda do Servidor.
 */
-void AuthClient::recv_dh()
+template <typename Policy>
+void BasicAuthClient<Policy>::recv_dh()
 {
     /******************** Recv Enc Packet ********************/
-    DHEncPacket encPacket;
-    int recv = soc.recv(&encPacket, sizeof(DHEncPacket));
+    byte datagram[wire::size<DHEncPacket>()];
+    int recv = soc->recv(datagram, sizeof(datagram));
 
     if (recv > 0)
     {
@@ -421,9 +635,11 @@ void AuthClient::recv_dh()
         t2 = currentTime();
         totalTime = elapsedTime(t1, t2);
 
-        if (isDisconnectRequest(encPacket))
+        /* O Servidor recusou o handshake. */
+        if (isDisconnectRequest(datagram))
         {
             rdisconnect();
+            throw DENIED;
         }
         else
         {
@@ -435,25 +651,26 @@ void AuthClient::recv_dh()
                 t_aux1 = currentTime();
 
                 /******************** Decrypt Exchange ********************/
+                DHEncPacket encPacket;
+                wire::decode(datagram, encPacket);
+
                 DHKeyExchange dhKeyExchange;
                 int *const encryptedExchange = encPacket.getEncryptedExchange();
-                byte *const dhExchangeBytes = iotAuth.decryptRSA(encryptedExchange, rsaStorage->getMyPrivateKey(), sizeof(DHKeyExchange));
+                byte *const dhExchangeBytes = iotAuth.decryptRSA(encryptedExchange, rsaStorage->getMyPrivateKey(), wire::size<DHKeyExchange>());
 
-                BytesToObject(dhExchangeBytes, dhKeyExchange, sizeof(DHKeyExchange));
-                delete[] dhExchangeBytes;
+                wire::decode(dhExchangeBytes, dhKeyExchange);
 
                 /******************** Get DH Package ********************/
                 DiffieHellmanPackage dhPackage = dhKeyExchange.getDiffieHellmanPackage();
 
                 /******************** Decrypt Hash ********************/
-                string decryptedHash = decryptHash(dhKeyExchange.getEncryptedHash());
+                byte *const decryptedHash = decryptHash(dhKeyExchange.getEncryptedHash());
 
                 /******************** Validity ********************/
-                string dhString = dhPackage.toString();
-                const bool isHashValid = iotAuth.isHashValid(&dhString, &decryptedHash);
-                const bool isNonceTrue = strcmp(dhPackage.getNonceA(), nonceA) == 0;
+                const bool isHashValid = iotAuth.isHashValid(&dhPackage, decryptedHash);
+                const bool isNonceTrue = dhPackage.getNonceA() == nonceA;
 
-                if (VERBOSE)
+                if (Policy::verbose)
                     recv_dh_verbose(&dhPackage, isHashValid, isNonceTrue);
 
                 if (isHashValid && isNonceTrue)
@@ -463,6 +680,9 @@ void AuthClient::recv_dh()
                     /******************** Store DH Package ********************/
                     storeDiffieHellman(&dhPackage);
 
+                    /******************** Step Time ********************/
+                    markStep(6);
+
                     send_dh();
                 }
                 else if (!isHashValid)
@@ -478,7 +698,7 @@ void AuthClient::recv_dh()
             }
             else
             {
-                if (VERBOSE)
+                if (Policy::verbose)
                     time_limit_burst_verbose();
                 done();
                 throw TIMEOUT;
@@ -487,7 +707,7 @@ void AuthClient::recv_dh()
     }
     else
     {
-        if (VERBOSE)
+        if (Policy::verbose)
             response_timeout_verbose();
         throw NO_REPLY;
     }
@@ -496,7 +716,8 @@ void AuthClient::recv_dh()
 /*  Step 7
     Realiza o envio dos dados Diffie-Hellman para o Servidor.
 */
-void AuthClient::send_dh()
+template <typename Policy>
+void BasicAuthClient<Policy>::send_dh()
 {
     /***************** Calculate DH ******************/
     const int sessionKey = dhStorage->calculateSessionKey(dhStorage->getSessionKey());
@@ -504,7 +725,7 @@ void AuthClient::send_dh()
     dhStorage->setSessionKey(sessionKey);
 
     /***************** Generate Nonce A ******************/
-    generateNonce(nonceA);
+    generateNonce(&nonceA);
 
     /***************** Mount Package ******************/
     DiffieHellmanPackage diffieHellmanPackage;
@@ -513,8 +734,7 @@ void AuthClient::send_dh()
     diffieHellmanPackage.setNonceB(nonceB);
 
     /***************** Encrypt Hash ******************/
-    string dhString = diffieHellmanPackage.toString();
-    int *const encryptedHash = iotAuth.signedHash(&dhString, rsaStorage->getMyPrivateKey());
+    int *const encryptedHash = iotAuth.signedHash(&diffieHellmanPackage, rsaStorage->getMyPrivateKey(), Policy::verbose);
 
     /***************** Stop Processing Time 2 ******************/
     t2 = currentTime();
@@ -526,30 +746,30 @@ void AuthClient::send_dh()
     dhSent.setDiffieHellmanPackage(diffieHellmanPackage);
 
     /********************** Serialize Exchange **********************/
-    byte *const exchangeBytes = new byte[sizeof(DHKeyExchange)];
-    ObjectToBytes(dhSent, exchangeBytes, sizeof(DHKeyExchange));
+    byte *const exchangeBytes = iotAuth.arena.array<byte>(wire::size<DHKeyExchange>());
+    wire::encode(dhSent, exchangeBytes);
 
     /********************** Encrypt Exchange **********************/
-    int *const encryptedExchange = iotAuth.encryptRSA(exchangeBytes, rsaStorage->getPartnerPublicKey(), sizeof(RSAKeyExchange));
+    int *const encryptedExchange = iotAuth.encryptRSA(exchangeBytes, rsaStorage->getPartnerPublicKey(), wire::size<DHKeyExchange>());
 
-    /********************** Mount Enc Packet **********************/
-    DHEncPacket encPacket;
-    encPacket.setEncryptedExchange(encryptedExchange);
-    encPacket.setTP(processingTime2);
+    /******************** Encode Exchange ********************/
+    /* A troca cifrada vai direto para a arena da sessão; o tempo de processamento segue à parte no envio. */
+    byte *const body = iotAuth.arena.array<byte>(wire::size<DHEncPacket>());
+    const size_t bodySize = DHEncPacket::encodeBody(encryptedExchange, body);
 
     /******************** Start Total Time ********************/
     t1 = currentTime();
 
     /******************** Send Enc Packet ********************/
-    soc.send((DHEncPacket *)&encPacket, sizeof(DHEncPacket));
+    sendTimed(body, bodySize, processingTime2);
 
     /******************** Verbose ********************/
-    if (VERBOSE)
-        send_dh_verbose(&diffieHellmanPackage, sessionKey, sequence, encPacket.getTP());
+    if (Policy::verbose)
+        send_dh_verbose(&diffieHellmanPackage, sessionKey, sequence, processingTime2);
+
 
-    delete[] exchangeBytes;
-    delete[] encryptedHash;
-    delete[] encryptedExchange;
+    /******************** Step Time ********************/
+    markStep(7);
 
     recv_dh_ack();
 }
@@ -557,11 +777,13 @@ void AuthClient::send_dh()
 /*  Step 8
     Recebe a confirmação do Servidor referente aos dados Diffie-Hellman enviados.
 */
-void AuthClient::recv_dh_ack()
+template <typename Policy>
+void BasicAuthClient<Policy>::recv_dh_ack()
 {
     /******************** Recv ACK ********************/
-    int encryptedACK[sizeof(DH_ACK)];
-    int recv = soc.recv(encryptedACK, sizeof(DH_ACK) * sizeof(int));
+    /* Um inteiro por byte do ACK codificado. */
+    byte datagram[wire::size<DH_ACK>() * wire::size<int>()];
+    int recv = soc->recv(datagram, sizeof(datagram));
 
     if (recv > 0)
     {
@@ -569,31 +791,45 @@ void AuthClient::recv_dh_ack()
         t2 = currentTime();
         totalTime = elapsedTime(t1, t2);
 
-        if (isDisconnectRequest(encryptedACK))
+        /* O Servidor recusou o handshake. */
+        if (isDisconnectRequest(datagram))
         {
             rdisconnect();
+            throw DENIED;
         }
         else
         {
             /******************** Proof of Time ********************/
-            const double limit = processingTime2 + networkTime + (processingTime2 + networkTime) * 0.1;
+            /* Folga de 10%, nunca menor que LIMIT_FLOOR_MS: o mesmo piso do limite RSA do Servidor. */
+            const double expected = processingTime2 + networkTime;
+            const double limit = expected + (expected * 0.1 > LIMIT_FLOOR_MS ? expected * 0.1 : LIMIT_FLOOR_MS);
 
             if (totalTime <= limit)
             {
                 /******************** Decrypt ACK ********************/
-                byte *const decryptedACKBytes = iotAuth.decryptRSA(encryptedACK, rsaStorage->getPartnerPublicKey(), sizeof(DH_ACK));
+                int encryptedACK[wire::size<DH_ACK>()];
+                wire::decode(datagram, wire::size<DH_ACK>(), encryptedACK);
+                byte *const decryptedACKBytes = iotAuth.decryptRSA(encryptedACK, rsaStorage->getPartnerPublicKey(), wire::size<DH_ACK>());
 
                 /******************** Deserialize ACK ********************/
                 DH_ACK ack;
-                BytesToObject(decryptedACKBytes, ack, sizeof(DH_ACK));
-                delete[] decryptedACKBytes;
+                wire::decode(decryptedACKBytes, ack);
 
                 /******************** Validity ********************/
-                const bool isNonceTrue = (strcmp(ack.nonce, nonceA) == 0);
+                const bool isNonceTrue = ack.nonce == nonceA;
 
                 if (isNonceTrue)
                 {
+                    /******************** Session Ticket ********************/
+                    if (Policy::tickets)
+                    {
+                        ticket = ack.ticket;
+                        ticketKey = dhStorage->getSessionKey();
+                        ticketIV = dhStorage->getIV();
+                    }
+
                     connected = true;
+                    markStep(8);
                     // data_transfer(soc);
                 }
                 else
@@ -603,12 +839,12 @@ void AuthClient::recv_dh_ack()
                 }
 
                 /******************** Verbose ********************/
-                if (VERBOSE)
+                if (Policy::verbose)
                     send_dh_ack_verbose(&ack, isNonceTrue);
             }
             else
             {
-                if (VERBOSE)
+                if (Policy::verbose)
                     time_limit_burst_verbose();
                 done();
                 throw TIMEOUT;
@@ -617,7 +853,7 @@ void AuthClient::recv_dh_ack()
     }
     else
     {
-        if (VERBOSE)
+        if (Policy::verbose)
             response_timeout_verbose();
         throw NO_REPLY;
     }
@@ -630,33 +866,34 @@ void AuthClient::recv_dh_ack()
     Verifica se a mensagem vinda do Cliente é uma confirmação do pedido de
     fim de conexão enviado pelo Servidor (DONE_ACK).
 */
-status AuthClient::wdc()
+template <typename Policy>
+status BasicAuthClient<Policy>::wdc()
 {
     char message[2];
-    int recv = soc.recv(message, sizeof(message));
+    int recv = soc->recv(message, sizeof(message));
 
     if (recv > 0)
     {
         if (message[0] == DONE_ACK_CHAR)
         {
-            if (VERBOSE)
+            if (Policy::verbose)
                 wdc_verbose();
 
             connected = false;
-            soc.finish();
+            soc->finish();
             return OK;
         }
         else
         {
             connected = false;
-            soc.finish();
+            soc->finish();
             return DENIED;
         }
     }
     else
     {
         connected = false;
-        soc.finish();
+        soc->finish();
         return NO_REPLY;
     }
 }
@@ -668,37 +905,39 @@ status AuthClient::wdc()
     Envia uma confirmação (DONE_ACK) para o pedido de término de conexão
     vindo do Servidor.
 */
-void AuthClient::rdisconnect()
+template <typename Policy>
+void BasicAuthClient<Policy>::rdisconnect()
 {
     int sent = 0;
 
     do
     {
-        sent = soc.send(DONE_ACK, strlen(DONE_ACK));
+        sent = soc->send(DONE_ACK, strlen(DONE_ACK));
     } while (sent <= 0);
 
     connected = false;
 
-    if (VERBOSE)
+    if (Policy::verbose)
         rft_verbose();
 
-    soc.finish();
+    soc->finish();
 }
 
 
 
 
 /*  Envia um pedido de fim de conexão para o cliente. */
-status AuthClient::done()
+template <typename Policy>
+status BasicAuthClient<Policy>::done()
 {
     int sent = 0;
 
     do
     {
-        sent = soc.send(DONE_MESSAGE, sizeof(DONE_MESSAGE));
+        sent = soc->send(DONE_MESSAGE, sizeof(DONE_MESSAGE));
     } while (sent <= 0);
 
-    if (VERBOSE)
+    if (Policy::verbose)
         done_verbose();
 
     return wdc();
@@ -708,12 +947,13 @@ status AuthClient::done()
 
 
 /*  Envia ACK confirmando o recebimento da publicação. */
-bool AuthClient::sack()
+template <typename Policy>
+bool BasicAuthClient<Policy>::sack()
 {
     char ack = ACK_CHAR;
-    uint8_t sent = soc.send(&ack, sizeof(ack));
+    uint8_t sent = soc->send(&ack, sizeof(ack));
 
-    if (send > 0)
+    if (sent > 0)
     {
         return true;
     }
@@ -724,18 +964,19 @@ bool AuthClient::sack()
 
 
 /*  Recebe ACK confirmando o recebimento da publicação. */
-bool AuthClient::rack()
+template <typename Policy>
+bool BasicAuthClient<Policy>::rack()
 {
-    int count = COUNT;
+    int count = Policy::retries;
     char ack = 'a';
-    int recv;
+    int recv = 0;
 
     while ((recv <= 0 || ack != ACK_CHAR) && count--)
     {
-        recv = soc.recv(&ack, sizeof(ack));
+        recv = soc->recv(&ack, sizeof(ack));
     }
 
-    if (ack == ACK)
+    if (ack == ACK_CHAR)
     {
         return true;
     } 
@@ -746,8 +987,9 @@ bool AuthClient::rack()
 
 
 /*  Verifica se a mensagem recebida é um pedido de desconexão. */
+template <typename Policy>
 template <typename T>
-bool AuthClient::isDisconnectRequest(T &object)
+bool BasicAuthClient<Policy>::isDisconnectRequest(T &object)
 {
     int cmp = memcmp(&object, DONE_MESSAGE, strlen(DONE_MESSAGE));
     return cmp == 0;
@@ -757,24 +999,13 @@ bool AuthClient::isDisconnectRequest(T &object)
 
 
 /*  Decrypt Hash
-    Decifra o hash obtido do pacote utilizando a chave pública do Cliente.
-    Retorna o hash em uma string.
+    Decifra o hash obtido do pacote utilizando a chave pública do Servidor.
+    Os IotAuth::HASH_SIZE bytes ficam na arena da sessão.
 */
-string AuthClient::decryptHash(int *encryptedHash)
+template <typename Policy>
+byte *BasicAuthClient<Policy>::decryptHash(int *encryptedHash)
 {
-    byte *const decryptedHash = iotAuth.decryptRSA(encryptedHash, rsaStorage->getPartnerPublicKey(), 128);
-
-    char aux;
-    string decryptedHashString = "";
-    for (int i = 0; i < 128; i++)
-    {
-        aux = decryptedHash[i];
-        decryptedHashString += aux;
-    }
-
-    delete[] decryptedHash;
-
-    return decryptedHashString;
+    return iotAuth.decryptRSA(encryptedHash, rsaStorage->getPartnerPublicKey(), IotAuth::HASH_SIZE);
 }
 
 
@@ -784,9 +1015,10 @@ string AuthClient::decryptHash(int *encryptedHash)
     Armazena os valores pertinentes a troca de chaves Diffie-Hellman:
     expoente, base, módulo, resultado e a chave de sessão.
 */
-void AuthClient::storeDiffieHellman(DiffieHellmanPackage *dhPackage)
+template <typename Policy>
+void BasicAuthClient<Policy>::storeDiffieHellman(DiffieHellmanPackage *dhPackage)
 {
-    dhStorage = new DHStorage();
+    dhStorage = iotAuth.arena.make<DHStorage>();
 
     dhStorage->setExponent(iotAuth.randomNumber(3) + 2);
     dhStorage->setBase(dhPackage->getBase());
@@ -798,37 +1030,46 @@ void AuthClient::storeDiffieHellman(DiffieHellmanPackage *dhPackage)
 
 
 
+/*  Libera de uma vez a memória da sessão (storages e buffers do RSA). */
+template <typename Policy>
+void BasicAuthClient<Policy>::release()
+{
+    iotAuth.arena.reset();
+    rsaStorage = NULL;
+    dhStorage = NULL;
+}
+
+
+
+
 /*  Encrypt Message
-    Encripta a mensagem utilizando a chave de sessão.
+    Cifra os 'length' primeiros bytes da mensagem, completada com zeros até
+    'size' bytes e um múltiplo do bloco AES, com a chave de sessão. O texto
+    cifrado é montado no próprio datagrama, já em hexadecimal, e o tamanho
+    a enviar é retornado.
 */
-string AuthClient::encryptMessage(char *message, int size)
+template <typename Policy>
+int BasicAuthClient<Policy>::encryptMessage(const char *message, int length, int size, Datagram *datagram)
 {
-    /* Inicialização do vetor plaintext. */
-    uint8_t plaintext[size];
-    memset(plaintext, 0, size);
+    const int padded = (size + AES_BLOCKLEN - 1) / AES_BLOCKLEN * AES_BLOCKLEN;
+
+    uint8_t *const plaintext = datagram->bytes;
+    memcpy(plaintext, message, length);
+    memset(plaintext + length, 0, padded - length);
 
     /* Inicialização da chave e do IV. */
-    uint8_t key[32];
-    for (int i = 0; i < 32; i++)
-    {
-        key[i] = dhStorage->getSessionKey();
-    }
+    uint8_t key[AES<Policy::aesKeyBits>::KEYLEN];
+    memset(key, dhStorage->getSessionKey(), sizeof(key));
 
     uint8_t iv[16];
-    for (int i = 0; i < 16; i++)
-    {
-        iv[i] = dhStorage->getIV();
-    }
-
-    /* Converte o array de char (message) para uint8_t. */
-    CharToUint8_t(message, plaintext, size);
+    memset(iv, dhStorage->getIV(), sizeof(iv));
 
-    /* Encripta a mensagem utilizando a chave e o iv declarados anteriormente. */
-    uint8_t *const encrypted = iotAuth.encryptAES(plaintext, key, iv, size);
+    /* Cifra e codifica no mesmo buffer. */
+    iotAuth.encryptAES<Policy::aesKeyBits>(plaintext, key, iv, padded);
+    BytesToHexStringInPlace(datagram->bytes, padded);
 
-    const string result = Uint8_tToHexString(encrypted, size);
-
-    return result;
+    datagram->size = 2 * padded;
+    return datagram->size;
 }
 
 
@@ -837,20 +1078,48 @@ string AuthClient::encryptMessage(char *message, int size)
 /*  Generate Nonce
     Gera um novo nonce, incrementando o valor de sequência.
 */
-void AuthClient::generateNonce(char *nonce)
+template <typename Policy>
+void BasicAuthClient<Policy>::generateNonce(Nonce *nonce)
 {
-    string message = stringTime() + *clientIP + *serverIP + to_string(sequence++);
-    string hash = iotAuth.hash(&message);
-
-    memset(nonce, '\0', 129);
-    strncpy(nonce, hash.c_str(), 128);
+    sequence++;
+    csprng::fill(nonce->bytes, NONCE_SIZE);
 }
 
 
 
 
 /*  Armazena o valor do nonce B em uma variável global. */
-void AuthClient::storeNonceB(char *nonce)
+template <typename Policy>
+void BasicAuthClient<Policy>::storeNonceB(Nonce nonce)
+{
+    nonceB = nonce;
+}
+
+
+
+
+/*  Junta o corpo da mensagem e o tempo de processamento na saída
+    (sendmsg): o corpo é codificado antes do início do tempo total e só os
+    8 bytes do tempo ficam para depois, sem copiar a mensagem inteira.
+*/
+template <typename Policy>
+int BasicAuthClient<Policy>::sendTimed(const byte *body, size_t size, double processingTime)
 {
-    strncpy(nonceB, nonce, sizeof(nonceB));
-}
\ No newline at end of file
+    byte time[wire::size<double>()];
+    wire::encode(processingTime, time);
+
+    struct iovec parts[2];
+    parts[0].iov_base = (void *)body;
+    parts[0].iov_len = size;
+    parts[1].iov_base = time;
+    parts[1].iov_len = sizeof(time);
+
+    return soc->sendv(parts, 2);
+}
+
+
+
+
+/*  Políticas disponíveis; uma política nova precisa ser instanciada aqui. */
+template class BasicAuthClient<DefaultPolicy>;
+template class BasicAuthClient<QuietPolicy>;
\ No newline at end of file
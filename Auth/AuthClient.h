@@ -16,43 +16,81 @@
 #include "../Diffie-Hellman/DHEncPacket.h"
 
 #include "../verbose/verbose_client.h"
+#include "../trace/trace.h"
+#include "SessionTicket.h"
+#include "Policy.h"
 
 #include "../Socket/UDPSocket.h"
+#include "../Socket/DatagramPool.h"
 
 using namespace std;
 
 /* Simulação das funções executadas pelo Arduino. */
 
-class AuthClient
+/*  Cliente configurado em tempo de compilação pela política (Policy.h). */
+template <typename Policy>
+class BasicAuthClient
 {
   public:
-    AuthClient();
+    BasicAuthClient();
+
+    /*  Utiliza o transporte informado no lugar do socket UDP padrão. */
+    BasicAuthClient(Transport *transport);
 
     /*  Inicia conexão com o Servidor. */
-    int connect(char *address, int port=DEFAULT_PORT);
+    int connect(char *address, int port=Policy::port);
 
     /*  Entra em estado de espera por dados vindos do Servidor. */
     string listen();
 
+    /*  Recebe uma mensagem do Servidor e a decifra no próprio buffer do
+        datagrama, sem cópias intermediárias. O conteúdo vale até release();
+        data é NULL se o Servidor encerrou a conexão ou a mensagem era inválida.
+    */
+    Received receive();
+
+    /*  Devolve ao pool o datagrama de uma mensagem recebida. */
+    void release(Received &message);
+
     /*  Envia dados para o Servidor. */
     int publish(char *data);
 
+    /*  Envia os primeiros 'size' bytes de dados para o Servidor (até MAX_PAYLOAD). */
+    int publish(char *data, int size);
+
     /*  Envia um pedido de término de conexão ao Servidor. */
     status disconnect();
 
     /*  Retorna um boolean para indicar se possui conexão com o Servidor. */
     bool isConnected();
 
+    /*  Retorna os instantes (currentTime) em que cada passo do último handshake
+        foi concluído. O índice 0 marca o início do connect() e o índice i o fim
+        do Step i.
+    */
+    const double *stepTimes();
+
+    /*  Descarta o ticket da última sessão; o próximo connect() faz o
+        handshake completo.
+    */
+    void forgetSession();
+
 
   private:
 
     IotAuth iotAuth;
+    DatagramPool datagrams;     /*  Buffers das mensagens recebidas e publicadas. */
     int sequence;
 
-    RSAStorage *rsaStorage;
-    DHStorage *dhStorage;
+    RSAStorage *rsaStorage = NULL;  /*  Ambos vivem na arena do iotAuth. */
+    DHStorage *dhStorage = NULL;
+
+    Ticket ticket;      /*  Ticket da última sessão (keyId 0 se não houver). */
+    int ticketKey = 0;  /*  Chave de sessão e IV selados no ticket.  */
+    int ticketIV = 0;
 
-    UDPSocket soc;
+    UDPSocket udpSocket;
+    Transport *soc;
 
     struct sockaddr_in servidor, cliente;
 
@@ -62,13 +100,20 @@ class AuthClient
     bool connected = false;
     char *clientIP;   /*  Endereço IP do Cliente.                 */
     char *serverIP;   /*  Endereço IP do Servidor.                */
-    char nonceA[129]; /*  Armazena o nonce gerado do Cliente.     */
-    char nonceB[129]; /*  Armazena o nonce recebido do Servidor.  */
+    Nonce nonceA; /*  Armazena o nonce gerado do Cliente.     */
+    Nonce nonceB; /*  Armazena o nonce recebido do Servidor.  */
 
     double networkTime, processingTime1, processingTime2, totalTime;
     double t1, t2;
     double t_aux1, t_aux2;
     double start;
+    double stepTime[9];
+    uint32_t session = 0;   /*  Identificador do handshake atual no trace. */
+
+    /*  Registra o fim do Step informado (0 para o início do handshake)
+        em stepTime e no trace.
+    */
+    void markStep(int step);
 
     /*  Step 1
         Envia pedido de início de conexão ao Servidor.   
@@ -80,6 +125,11 @@ class AuthClient
     */
     void recv_ack();
 
+    /*  Resume
+        Conclui a retomada aceita pelo Servidor, no lugar dos Steps 3 a 8.
+    */
+    void recv_resume_ack(structResumeAck *received);
+
     /*  Step 3
         Realiza o envio dos dados RSA para o Servidor.  
     */
@@ -139,9 +189,9 @@ class AuthClient
 
     /*  Decrypt Hash
         Decifra o hash obtido do pacote utilizando a chave pública do Servidor.
-        Retorna o hash em uma string.
+        Os IotAuth::HASH_SIZE bytes ficam na arena da sessão.
     */
-    string decryptHash(int *encryptedHash);
+    byte *decryptHash(int *encryptedHash);
 
     /*  Store Diffie-Hellman
         Armazena os valores pertinentes a troca de chaves Diffie-Hellman:
@@ -149,18 +199,35 @@ class AuthClient
     */
     void storeDiffieHellman(DiffieHellmanPackage *dhPackage);
 
+    /*  Libera de uma vez a memória da sessão (storages e buffers do RSA). */
+    void release();
+
+    /*  Cifra os 'length' primeiros bytes de dados em uma mensagem de 'size'
+        bytes e a envia ao Servidor, sem alocação nem cópias intermediárias.
+    */
+    int publishMessage(const char *data, int length, int size);
+
     /*  Encrypt Message
-        Encripta a mensagem utilizando a chave de sessão.
+        Cifra a mensagem com a chave de sessão no próprio datagrama, já em
+        hexadecimal, e retorna o tamanho a enviar.
     */
-    string encryptMessage(char *message, int size);
+    int encryptMessage(const char *message, int length, int size, Datagram *datagram);
+
+    /*  Send Timed
+        Envia os 'size' bytes do corpo já codificado e o tempo de
+        processamento, último campo da mensagem, como um só datagrama.
+    */
+    int sendTimed(const byte *body, size_t size, double processingTime);
 
     /*  Generate Nonce
         Gera um novo nonce, incrementando o valor de sequência.
     */
-    void generateNonce(char *nonce);
+    void generateNonce(Nonce *nonce);
 
     /*  Armazena o valor do nonce B em uma variável global. */
-    void storeNonceB(char *nonce);
+    void storeNonceB(Nonce nonce);
 };
 
+typedef BasicAuthClient<DefaultPolicy> AuthClient;
+
 #endif
@@ -1,15 +1,32 @@
 #include "AuthServer.h"
 
-AuthServer::AuthServer()
+using namespace server_verbose;
+
+template <typename Policy>
+BasicAuthServer<Policy>::BasicAuthServer() : BasicAuthServer(&udpSocket)
+{
+}
+
+
+
+
+/*  Utiliza o transporte informado no lugar do socket UDP padrão. */
+template <typename Policy>
+BasicAuthServer<Policy>::BasicAuthServer(Transport *transport) : soc(transport)
 {
     memset(buffer, 0, sizeof(buffer));
+
+    /* O RSA de cada handshake roda no strand da sessão, em threads compartilhadas pelos Servidores do processo. */
+    if (Policy::cryptoWorkers > 0)
+        SessionScheduler::start(Policy::cryptoWorkers);
 }
 
 
 
 
 /*  Aguarda conexão com algum Cliente. */
-bool AuthServer::wait_connection()
+template <typename Policy>
+bool BasicAuthServer<Policy>::wait_connection()
 {
     if (!isConnected()) 
     {
@@ -23,115 +40,151 @@ bool AuthServer::wait_connection()
 
 
 /*  Entra em estado de espera por dados vindos do Cliente. */
-string AuthServer::listen()
+template <typename Policy>
+string BasicAuthServer<Policy>::listen()
 {
-    if (isConnected())
-    {
-        /********************* Recebimento dos Dados Cifrados *********************/
-        char message[1333];
-        memset(message, '\0', sizeof(message));
-        int recv = 0;
-        int count = COUNT;
+    Received message = receive();
+    if (message.data == NULL)
+        return "";
 
-        while (recv <= 0 && count--)
-        {
-            recv = soc.recv(message, sizeof(message) - 1);
-        }
+    const string result(message.data, strnlen(message.data, message.size));
+    release(message);
+    return result;
+}
 
-        if (count == 0)
-        {
-            throw TIMEOUT;
-        }
 
-        if (isDisconnectRequest(message))
-        {
-            rdisconnect();
-        }
-        else
-        {
-            /**************** RECEBE A MENSAGEM *****************************************/
-            /* Converte o array de chars (buffer) em uma string. */
-            string encryptedMessage(message);
-
-            /* Inicialização dos vetores ciphertext. */
-            char ciphertextChar[encryptedMessage.length()];
-            uint8_t ciphertext[encryptedMessage.length()];
-            memset(ciphertext, '\0', encryptedMessage.length());
-
-            /* Inicialização do vetor plaintext. */
-            uint8_t plaintext[encryptedMessage.length()];
-            memset(plaintext, '\0', encryptedMessage.length());
-
-            /* Inicialização da chave e iv. */
-            uint8_t key[32];
-            for (int i = 0; i < 32; i++)
-            {
-                key[i] = diffieHellmanStorage->getSessionKey();
-            }
 
-            uint8_t iv[16];
-            for (int i = 0; i < 16; i++)
-            {
-                iv[i] = diffieHellmanStorage->getIV();
-            }
 
-            /* Converte a mensagem recebida (HEXA) para o array de char ciphertextChar. */
-            HexStringToCharArray(&encryptedMessage, encryptedMessage.length(), ciphertextChar);
+/*  Recebe uma mensagem do Cliente e a decifra no próprio buffer do
+    datagrama, sem cópias intermediárias. O conteúdo vale até release();
+    data é NULL se o Cliente encerrou a conexão ou a mensagem era inválida.
+*/
+template <typename Policy>
+Received BasicAuthServer<Policy>::receive()
+{
+    Received message = {NULL, 0, NULL};
+    if (!isConnected())
+        return message;
 
-            /* Converte ciphertextChar em um array de uint8_t (ciphertext). */
-            CharToUint8_t(ciphertextChar, ciphertext, encryptedMessage.length());
+    /********************* Recebimento dos Dados Cifrados *********************/
+    Datagram *const datagram = datagrams.acquire();
+    int recv = 0;
+    int count = Policy::retries;
+
+    while (recv <= 0 && count--)
+    {
+        recv = soc->recv(datagram->bytes, sizeof(datagram->bytes) - 1);
+    }
 
-            /* Decifra a mensagem em um vetor de uint8_t. */
-            uint8_t *decrypted = iotAuth.decryptAES(ciphertext, key, iv, encryptedMessage.length());
-            // cout << "Decrypted: " << decrypted << endl << endl;
+    if (recv <= 0)
+    {
+        datagrams.release(datagram);
+        throw TIMEOUT;
+    }
+    datagram->bytes[recv] = '\0';
 
-            /************************** ENVIA ACK CONFIRMANDO ********************************/
-            while (sack() == false);
+    if (isDisconnectRequest(datagram->bytes))
+    {
+        datagrams.release(datagram);
+        rdisconnect();
+        return message;
+    }
 
-            return Uint8_tToString(decrypted, encryptedMessage.length());
-        }
+    /**************** Decifra no Buffer do Datagrama ****************/
+    /* Hexadecimal para bytes e, em seguida, AES no mesmo lugar; só blocos inteiros são decifrados. */
+    const int size = HexStringToBytesInPlace((char *)datagram->bytes, recv) / AES_BLOCKLEN * AES_BLOCKLEN;
+    if (size <= 0)
+    {
+        datagrams.release(datagram);
+        return message;
     }
+
+    uint8_t key[AES<Policy::aesKeyBits>::KEYLEN];
+    memset(key, diffieHellmanStorage->getSessionKey(), sizeof(key));
+
+    uint8_t iv[16];
+    memset(iv, diffieHellmanStorage->getIV(), sizeof(iv));
+
+    iotAuth.decryptAES<Policy::aesKeyBits>(datagram->bytes, key, iv, size);
+    datagram->size = size;
+
+    /************************** ENVIA ACK CONFIRMANDO ********************************/
+    while (sack() == false);
+
+    if (Policy::trace)
+        trace::record(trace::SERVER, trace::RECEIVE, session, OK);
+
+    message.data = (const char *)datagram->bytes;
+    message.size = size;
+    message.datagram = datagram;
+    return message;
+}
+
+
+
+
+/*  Devolve ao pool o datagrama de uma mensagem recebida. */
+template <typename Policy>
+void BasicAuthServer<Policy>::release(Received &message)
+{
+    datagrams.release(message.datagram);
+    message.data = NULL;
+    message.datagram = NULL;
 }
 
 
 
 
 /*  Envia dados para o Cliente. */
-status AuthServer::publish(char *data)
+template <typename Policy>
+status BasicAuthServer<Policy>::publish(char *data)
+{
+    /* Texto: nada depois do terminador é lido, mas a mensagem mantém MAX_PAYLOAD bytes. */
+    return publishMessage(data, strnlen(data, MAX_PAYLOAD), MAX_PAYLOAD);
+}
+
+
+
+
+/*  Cifra os 'length' primeiros bytes de dados em uma mensagem de 'size'
+    bytes e a envia ao Cliente. A mensagem é montada em um datagrama da
+    sessão: nada é alocado nem copiado no caminho.
+*/
+template <typename Policy>
+status BasicAuthServer<Policy>::publishMessage(const char *data, int length, int size)
 {
     if (isConnected()) {
-        string encrypted = encryptMessage(data, 666);
+        Datagram *const datagram = datagrams.acquire();
+        const int bytes = encryptMessage(data, length, size, datagram);
 
-        // cout << "Encrypted Message: " << encrypted << endl;
-        
-        int sent = soc.send(encrypted.c_str(), encrypted.length());
+        int sent = soc->send(datagram->bytes, bytes);
+        datagrams.release(datagram);
 
-        if (sent > 0)
-        {
-            if (rack())
-            {
-                return OK;
-            }
-            return DENIED;
-        }
-        else
-            return DENIED;
+        const status result = sent > 0 && rack() ? OK : DENIED;
+
+        if (Policy::trace)
+            trace::record(trace::SERVER, trace::PUBLISH, session, result);
+
+        return result;
     } else {
         cout << "Não existe conexão com o servidor!" << endl;
         return NOT_CONNECTED;
     }
-    return DENIED;
 }
 
 
 
 
 /*  Envia um pedido de término de conexão ao Cliente. */
-status AuthServer::disconnect()
+template <typename Policy>
+status BasicAuthServer<Policy>::disconnect()
 {
     if (isConnected())
     {
-        return done();
+        const status result = done();
+        if (Policy::trace)
+            trace::record(trace::SERVER, trace::DISCONNECT, session, result);
+        return result;
     }
     else
     {
@@ -144,7 +197,8 @@ status AuthServer::disconnect()
 
 
 /*  Retorna um boolean para indicar se possui conexão com o Cliente. */
-bool AuthServer::isConnected()
+template <typename Policy>
+bool BasicAuthServer<Policy>::isConnected()
 {
     return connected;
 }
@@ -152,38 +206,106 @@ bool AuthServer::isConnected()
 
 
 
+/*  Registra o fim do Step informado (0 para o início do handshake) no trace. */
+template <typename Policy>
+void BasicAuthServer<Policy>::markStep(int step)
+{
+    if (Policy::trace)
+        trace::record(trace::SERVER, step, session, OK);
+}
+
+
+
+
 /*  Step 1
     Recebe um pedido de início de conexão por parte do Cliente.
+    O ACK leva um cookie e o Servidor volta a esperar: SYNs são respondidos
+    sem guardar estado, e o handshake só começa quando chega um RSA com um
+    cookie válido (Step 3).
 */
-void AuthServer::recv_syn()
+template <typename Policy>
+void BasicAuthServer<Policy>::recv_syn()
 {
-    structSyn received;
-    
-    int recv = 0;
-
-    while (recv <= 0)
+    /* SYN, SYN de retomada e RSA chegam pela mesma espera; o tamanho recebido os diferencia. */
+    static_assert(wire::size<structSyn>() != wire::size<structResume>() &&
+                      wire::size<structSyn>() != wire::size<RSAKeyExchange>() &&
+                      wire::size<structResume>() != wire::size<RSAKeyExchange>(),
+                  "SYN, resume and RSA must differ in size on the wire");
+    byte datagram[wire::size<RSAKeyExchange>() > wire::size<structResume>() ? wire::size<RSAKeyExchange>() : wire::size<structResume>()];
+
+    while (true)
     {
-        recv = soc.recv(&received, sizeof(syn));
-    }
+        int recv = 0;
 
-    start = currentTime();
+        while (recv <= 0)
+        {
+            recv = soc->recv(datagram, sizeof(datagram));
+        }
+
+        peer = soc->peer_address();
+
+        if (recv == wire::size<RSAKeyExchange>())
+        {
+            /******************** Admission ********************/
+            if (!admit(true))
+                continue;
+
+            RSAKeyExchange rsaReceived;
+            wire::decode(datagram, rsaReceived);
+            recv_rsa(&rsaReceived);
+            return;
+        }
+
+        /* Verifica se a mensagem recebida é um SYN; o de retomada começa com os mesmos campos. */
+        const bool isResume = recv == wire::size<structResume>();
+        structResume received;
+        if (isResume)
+            wire::decode(datagram, received);
+        else if (recv == wire::size<structSyn>())
+        {
+            structSyn syn;
+            wire::decode(datagram, syn);
+            received.message = syn.message;
+            received.nonce = syn.nonce;
+        }
+
+        /* Um DONE encerra a espera: é assim que um Cliente desiste de um handshake. */
+        if (recv == sizeof(DONE_MESSAGE) && isDisconnectRequest(datagram))
+            throw FINISHED;
+
+        /* Qualquer outra coisa (publicação atrasada, DONE_ACK, lixo) é descartada sem estado, como o SYN. */
+        if ((!isResume && recv != wire::size<structSyn>()) || received.message != SYN)
+        {
+            if (Policy::metrics)
+                metrics::shed(metrics::SHED_STRAY);
+            continue;
+        }
+
+        /******************** Admission ********************/
+        if (!admit(false))
+            continue;
+
+        start = currentTime();
+
+        session = trace::newSession();
+        markStep(0);
 
-    /* Verifica se a mensagem recebida é um SYN. */
-    if (received.message == SYN)
-    {
         /******************** Store Nonce A ********************/
         storeNonceA(received.nonce);
 
         /******************** Verbose ********************/
-        if (VERBOSE)
+        if (Policy::verbose)
             recv_syn_verbose(nonceA);
 
+        /******************** Step Time ********************/
+        markStep(1);
+
+        /******************** Resumption ********************/
+        if (Policy::tickets && isResume && send_resume_ack(&received))
+            return;
+
         send_ack();
     }
-    else
-    {
-        throw DENIED;
-    }
 }
 
 
@@ -192,30 +314,96 @@ void AuthServer::recv_syn()
 /*  Step 2
     Envia confirmação ao Cliente referente ao pedido de início de conexão.
 */
-void AuthServer::send_ack()
+template <typename Policy>
+void BasicAuthServer<Policy>::send_ack()
 {
-    /******************** Init Sequence ********************/
-    sequence = iotAuth.randomNumber(9999);
-
-    /******************** Generate Nounce B ********************/
-    generateNonce(nonceB);
+    /******************** Generate Cookie ********************/
+    cookies::make(peer, nonceA, session, &nonceB);
 
     /******************** Mount Package ********************/
     structAck toSend;
-    strncpy(toSend.nonceA, nonceA, sizeof(toSend.nonceA));
-    strncpy(toSend.nonceB, nonceB, sizeof(toSend.nonceB));
-
-    /******************** Start Network Time ********************/
-    t1 = currentTime();
+    toSend.nonceA = nonceA;
+    toSend.nonceB = nonceB;
 
     /******************** Send Package ********************/
-    soc.send(&toSend, sizeof(ack));
+    byte datagram[wire::size<structAck>()];
+    wire::encode(toSend, datagram);
+    soc->send(datagram, sizeof(datagram));
 
     /******************** Verbose ********************/
-    if (VERBOSE)
+    if (Policy::verbose)
         send_ack_verbose(nonceB, sequence, serverIP, clientIP);
 
-    recv_rsa();
+    /******************** Step Time ********************/
+    markStep(2);
+}
+
+
+
+
+/*  Resume
+    Retoma a sessão do ticket recebido no SYN, no lugar dos Steps 2 a 8.
+    Retorna false se o ticket ou a prova forem inválidos, e o handshake
+    segue completo.
+*/
+template <typename Policy>
+bool BasicAuthServer<Policy>::send_resume_ack(structResume *received)
+{
+    /******************** Open Ticket ********************/
+    /* Sem a chave que selou o ticket (por exemplo, após reiniciar), recorre ao cache persistente. */
+    int sessionKey, iv;
+    if (!tickets::open(received->ticket, &sessionKey, &iv) && !sessions::find(received->ticket, &sessionKey, &iv))
+        return false;
+
+    /******************** Validity ********************/
+    uint8_t proof[PROOF_SIZE];
+    tickets::proof(sessionKey, iv, nonceA, Nonce(), proof);
+    if (!constantTimeEquals(proof, received->proof, PROOF_SIZE))
+        return false;
+
+    /* Um ticket já retomado é recusado, mesmo que sua chave ainda o abra. */
+    if (!tickets::redeem(received->ticket))
+        return false;
+    sessions::erase(received->ticket);
+
+    /******************** Generate Nonce B ********************/
+    sequence = iotAuth.randomNumber(9999);
+    generateNonce(&nonceB);
+
+    /******************** Derive Session Key ********************/
+    tickets::derive(&sessionKey, &iv, nonceA, nonceB);
+
+    diffieHellmanStorage = iotAuth.arena.make<DHStorage>();
+    diffieHellmanStorage->setSessionKey(sessionKey);
+    diffieHellmanStorage->setIV(iv);
+
+    /******************** Mount Package ********************/
+    structResumeAck toSend;
+    toSend.nonceA = nonceA;
+    toSend.nonceB = nonceB;
+    tickets::proof(sessionKey, iv, nonceA, nonceB, toSend.proof);
+    toSend.ticket = tickets::issue(sessionKey, iv);
+    sessions::store(toSend.ticket, sessionKey, iv);
+
+    /******************** Send Package ********************/
+    byte datagram[wire::size<structResumeAck>()];
+    wire::encode(toSend, datagram);
+    soc->send(datagram, sizeof(datagram));
+
+    connected = true;
+
+    /******************** Trace ********************/
+    if (Policy::trace)
+        trace::record(trace::SERVER, trace::RESUME, session, OK);
+
+    /******************** Metrics ********************/
+    if (Policy::metrics)
+    {
+        metrics::record(metrics::RESUME_TIME, elapsedTime(start, currentTime()));
+        metrics::count(OK);
+    }
+
+    return true;
 }
 
 
@@ -223,74 +411,72 @@ void AuthServer::send_ack()
 
 /*  Step 3
     Recebe os dados RSA vindos do Cliente.
+    Só aqui o handshake passa a ter estado: o cookie devolvido no nonce B
+    precisa ser válido para o endereço e o nonce A do Cliente.
 */
-void AuthServer::recv_rsa()
+template <typename Policy>
+void BasicAuthServer<Policy>::recv_rsa(RSAKeyExchange *rsaReceived)
 {
-    /******************** Receive Exchange ********************/
-    RSAKeyExchange rsaReceived;
-    int recv = soc.recv(&rsaReceived, sizeof(RSAKeyExchange));
+    /******************** Stop Network Time ********************/
+    t2 = currentTime();
 
-    if (recv > 0)
+    /******************** Validity Cookie ********************/
+    RSAPackage rsaPackage = *rsaReceived->getRSAPackage();
+
+    uint32_t cookieSession;
+    if (!cookies::check(peer, rsaPackage.getNonceA(), rsaPackage.getNonceB(), &cookieSession, &t1))
     {
-        if (isDisconnectRequest(rsaReceived))
-        {
-            rdisconnect();
-        }
-        else
-        {
-            /******************** Stop Network Time ********************/
-            t2 = currentTime();
-            networkTime = elapsedTime(t1, t2);
+        /* Sem sessão a encerrar: responder a um endereço possivelmente forjado só ampliaria o ataque. */
+        session = 0;
+        throw DENIED;
+    }
 
-            /******************** Start Processing Time ********************/
-            t1 = currentTime();
+    /* O cookie traz o handshake do trace e o instante do ACK (Step 2). */
+    session = cookieSession;
+    iotAuth.strand = session;
+    start = t1;
+    networkTime = elapsedTime(t1, t2);
 
-            /******************** Store RSA Data ********************/
-            RSAPackage rsaPackage = *rsaReceived.getRSAPackage();
+    nonceB = rsaPackage.getNonceB();
 
-            rsaStorage = new RSAStorage();
-            rsaStorage->setPartnerPublicKey(rsaPackage.getPublicKey());
-            rsaStorage->setPartnerFDR(rsaPackage.getFDR());
+    /******************** Init Sequence ********************/
+    sequence = iotAuth.randomNumber(9999);
 
-            /******************** Decrypt Hash ********************/
-            string rsaString = rsaPackage.toString();
-            string decryptedHash = decryptHash(rsaReceived.getEncryptedHash());
+    /******************** Start Processing Time ********************/
+    t1 = currentTime();
 
-            /******************** Store TP ********************/
-            tp = rsaReceived.getProcessingTime();
+    /******************** Store RSA Data ********************/
+    rsaStorage = iotAuth.arena.make<RSAStorage>();
+    rsaStorage->setPartnerPublicKey(rsaPackage.getPublicKey());
+    rsaStorage->setPartnerFDR(rsaPackage.getFDR());
 
-            /******************** Store Nonce A ********************/
-            storeNonceA(rsaPackage.getNonceA());
+    /******************** Decrypt Hash ********************/
+    byte *const decryptedHash = decryptHash(rsaReceived->getEncryptedHash());
 
-            /******************** Validity Hash ********************/
-            bool isHashValid = iotAuth.isHashValid(&rsaString, &decryptedHash);
-            bool isNonceTrue = strcmp(rsaPackage.getNonceB(), nonceB) == 0;
+    /******************** Store TP ********************/
+    tp = rsaReceived->getProcessingTime();
 
-            /******************** Verbose ********************/
-            if (VERBOSE)
-                recv_rsa_verbose(rsaStorage, nonceA, isHashValid, isNonceTrue);
+    /******************** Store Nonce A ********************/
+    storeNonceA(rsaPackage.getNonceA());
 
-            if (isHashValid && isNonceTrue)
-            {
-                send_rsa();
-            }
-            else if (!isHashValid)
-            {
-                disconnect();
-                throw HASH_INVALID;
-            }
-            else
-            {
-                disconnect();
-                throw NONCE_INVALID;
-            }
-        }
+    /******************** Validity Hash ********************/
+    bool isHashValid = iotAuth.isHashValid(&rsaPackage, decryptedHash);
+
+    /******************** Verbose ********************/
+    if (Policy::verbose)
+        recv_rsa_verbose(rsaStorage, nonceA, isHashValid, true);
+
+    if (isHashValid)
+    {
+        /******************** Step Time ********************/
+        markStep(3);
+
+        send_rsa();
     }
     else
     {
-        if (VERBOSE)
-            response_timeout_verbose();
-        throw NO_REPLY;
+        reject();
+        throw HASH_INVALID;
     }
 }
 
@@ -301,7 +487,8 @@ void AuthServer::recv_rsa()
 /*  Step 4
     Realiza o envio dos dados RSA para o Cliente.
 */
-void AuthServer::send_rsa()
+template <typename Policy>
+void BasicAuthServer<Policy>::send_rsa()
 {
     /******************** Start Auxiliar Time ********************/
     t_aux1 = currentTime();
@@ -314,7 +501,7 @@ void AuthServer::send_rsa()
     rsaStorage->setMyFDR(iotAuth.generateFDR());
 
     /******************** Generate Nonce ********************/
-    generateNonce(nonceB);
+    generateNonce(&nonceB);
 
     /******************** Mount Package ********************/
     RSAPackage rsaSent;
@@ -324,13 +511,8 @@ void AuthServer::send_rsa()
     rsaSent.setNonceA(nonceA);
     rsaSent.setNonceB(nonceB);
 
-    /******************** Get Hash ********************/
-    string packageString = rsaSent.toString();
-    string hash = iotAuth.hash(&packageString);
-
-
-    /******************** Encrypt Hash ********************/
-    int *const encryptedHash = iotAuth.encryptRSA(&hash, rsaStorage->getMyPrivateKey(), 128);
+    /******************** Sign Hash ********************/
+    int *const encryptedHash = iotAuth.signedHash(&rsaSent, rsaStorage->getMyPrivateKey(), Policy::verbose);
 
     /******************** Stop Processing Time ********************/
     t2 = currentTime();
@@ -343,25 +525,32 @@ void AuthServer::send_rsa()
     /******************** Rectify Network Time ********************/
     networkTime = networkTime - auxiliarTime;
 
-    /******************** Mount Exchange ********************/
-    RSAKeyExchange rsaExchange;
-    rsaExchange.setRSAPackage(&rsaSent);
-    rsaExchange.setEncryptedHash(encryptedHash);
-    rsaExchange.setProcessingTime(processingTime1);
+    /******************** Metrics ********************/
+    if (Policy::metrics)
+    {
+        metrics::record(metrics::NETWORK_TIME, networkTime);
+        metrics::record(metrics::PROCESSING_TIME1, processingTime1);
+        metrics::record(metrics::AUXILIAR_TIME, auxiliarTime);
+    }
+
+    /******************** Encode Exchange ********************/
+    /* Pacote e hash vão direto para a arena da sessão; o tempo de processamento segue à parte no envio. */
+    byte *const body = iotAuth.arena.array<byte>(wire::size<RSAKeyExchange>());
+    const size_t bodySize = RSAKeyExchange::encodeBody(rsaSent, encryptedHash, body);
 
     /******************** Start Total Time ********************/
     t1 = currentTime();
 
     /******************** Send Exchange ********************/
-    soc.send((RSAKeyExchange *)&rsaExchange, sizeof(RSAKeyExchange));
-
-    /******************** Memory Release ********************/
-    delete[] encryptedHash;
+    sendTimed(body, bodySize, processingTime1);
 
     /******************** Verbose ********************/
-    if (VERBOSE)
+    if (Policy::verbose)
         send_rsa_verbose(rsaStorage, sequence, nonceB);
 
+    /******************** Step Time ********************/
+    markStep(4);
+
     recv_rsa_ack();
 }
 
@@ -372,14 +561,15 @@ void AuthServer::send_rsa()
 /*  Step 5
     Recebe confirmação do Cliente referente ao recebimento dos dados RSA.
 */
-void AuthServer::recv_rsa_ack()
+template <typename Policy>
+void BasicAuthServer<Policy>::recv_rsa_ack()
 {
-    RSAKeyExchange rsaReceived;
-    int recv = soc.recv(&rsaReceived, sizeof(RSAKeyExchange));
+    byte datagram[wire::size<RSAKeyExchange>()];
+    int recv = soc->recv(datagram, sizeof(datagram));
 
     if (recv > 0)
     {
-        if (isDisconnectRequest(rsaReceived))
+        if (isDisconnectRequest(datagram))
         {
             rdisconnect();
         }
@@ -389,62 +579,71 @@ void AuthServer::recv_rsa_ack()
             t2 = currentTime();
             totalTime = elapsedTime(t1, t2);
 
+            if (Policy::metrics)
+                metrics::record(metrics::TOTAL_TIME_RSA, totalTime);
+
             /******************** Proof of Time ********************/
-            double limit = processingTime1 + networkTime + (processingTime1 + networkTime)*0.1;
-            // double limit = 1000;
+            double limit = limits::rsa(peer, processingTime1 + networkTime);
 
             if (totalTime <= limit)
             {
                 /******************** Get Package ********************/
+                RSAKeyExchange rsaReceived;
+                wire::decode(datagram, rsaReceived);
                 RSAPackage rsaPackage = *rsaReceived.getRSAPackage();
 
                 /******************** Decrypt Hash ********************/
-                string rsaString = rsaPackage.toString();
-                string decryptedHash = decryptHash(rsaReceived.getEncryptedHash());
+                byte *const decryptedHash = decryptHash(rsaReceived.getEncryptedHash());
 
                 /******************** Store Nonce A ********************/
                 storeNonceA(rsaPackage.getNonceA());
 
-                bool isHashValid = iotAuth.isHashValid(&rsaString, &decryptedHash);
-                bool isNonceTrue = strcmp(rsaPackage.getNonceB(), nonceB) == 0;
+                bool isHashValid = iotAuth.isHashValid(&rsaPackage, decryptedHash);
+                bool isNonceTrue = rsaPackage.getNonceB() == nonceB;
                 bool isAnswerCorrect = iotAuth.isAnswerCorrect(rsaStorage->getMyFDR(), rsaStorage->getMyPublicKey()->d, rsaPackage.getAnswerFDR());
 
-                if (VERBOSE)
+                if (Policy::verbose)
                     recv_rsa_ack_verbose(nonceA, isHashValid, isAnswerCorrect, isNonceTrue);
 
                 /******************** Validity ********************/
                 if (isHashValid && isNonceTrue && isAnswerCorrect)
                 {
+                    /* Só provas aceitas ensinam o limite: um Cliente rejeitado não o influencia. */
+                    limits::learnRSA(peer, processingTime1 + networkTime, totalTime);
+
+                    /******************** Step Time ********************/
+                    markStep(5);
+
                     send_dh();
                 }
                 else if (!isHashValid)
                 {
-                    disconnect();
+                    reject();
                     throw HASH_INVALID;
                 }
                 else if (!isNonceTrue)
                 {
-                    disconnect();
+                    reject();
                     throw NONCE_INVALID;
                 }
                 else
                 {
-                    disconnect();
+                    reject();
                     throw FDR_INVALID;
                 }
             }
             else
             {
-                if (VERBOSE)
+                if (Policy::verbose)
                     time_limit_burst_verbose();
-                disconnect();
+                reject();
                 throw TIMEOUT;
             }
         }
     }
     else
     {
-        if (VERBOSE)
+        if (Policy::verbose)
             response_timeout_verbose();
 
         throw NO_REPLY;
@@ -457,7 +656,8 @@ void AuthServer::recv_rsa_ack()
 /*  Step 6
     Realiza o envio dos dados Diffie-Hellman para o Cliente.
 */
-void AuthServer::send_dh()
+template <typename Policy>
+void BasicAuthServer<Policy>::send_dh()
 {
     /******************** Start Processing Time 2 ********************/
     t_aux1 = currentTime();
@@ -466,7 +666,7 @@ void AuthServer::send_dh()
     generateDiffieHellman();
 
     /******************** Generate Nonce B ********************/
-    generateNonce(nonceB);
+    generateNonce(&nonceB);
 
     /******************** Generate IV ********************/
     int iv = iotAuth.randomNumber(90);
@@ -481,12 +681,8 @@ void AuthServer::send_dh()
     dhPackage.setNonceB(nonceB);
     dhPackage.setIV(iv);
 
-    /******************** Get Hash ********************/
-    string packageString = dhPackage.toString();
-    string hash = iotAuth.hash(&packageString);
-
-    /******************** Encrypt Hash ********************/
-    int *const encryptedHash = iotAuth.encryptRSA(&hash, rsaStorage->getMyPrivateKey(), hash.length());
+    /******************** Sign Hash ********************/
+    int *const encryptedHash = iotAuth.signedHash(&dhPackage, rsaStorage->getMyPrivateKey(), Policy::verbose);
 
     /******************** Mount Exchange ********************/
     DHKeyExchange dhSent;
@@ -494,36 +690,36 @@ void AuthServer::send_dh()
     dhSent.setDiffieHellmanPackage(dhPackage);
 
     /********************** Serialization Exchange **********************/
-    byte *const dhExchangeBytes = new byte[sizeof(DHKeyExchange)];
-    ObjectToBytes(dhSent, dhExchangeBytes, sizeof(DHKeyExchange));
+    byte *const dhExchangeBytes = iotAuth.arena.array<byte>(wire::size<DHKeyExchange>());
+    wire::encode(dhSent, dhExchangeBytes);
 
     /******************** Encryption Exchange ********************/
-    int *const encryptedExchange = iotAuth.encryptRSA(dhExchangeBytes, rsaStorage->getPartnerPublicKey(), sizeof(DHKeyExchange));
-    delete[] dhExchangeBytes;
+    int *const encryptedExchange = iotAuth.encryptRSA(dhExchangeBytes, rsaStorage->getPartnerPublicKey(), wire::size<DHKeyExchange>());
 
     /******************** Stop Processing Time 2 ********************/
     t_aux2 = currentTime();
-    processingTime2 = elapsedTime(t1, t2);
+    processingTime2 = elapsedTime(t_aux1, t_aux2);
 
-    /******************** Mount Enc Packet ********************/
-    DHEncPacket encPacket;
-    encPacket.setEncryptedExchange(encryptedExchange);
+    if (Policy::metrics)
+        metrics::record(metrics::PROCESSING_TIME2, processingTime2);
 
-    encPacket.setTP(processingTime2);
+    /******************** Encode Exchange ********************/
+    /* A troca cifrada vai direto para a arena da sessão; o tempo de processamento segue à parte no envio. */
+    byte *const body = iotAuth.arena.array<byte>(wire::size<DHEncPacket>());
+    const size_t bodySize = DHEncPacket::encodeBody(encryptedExchange, body);
 
     /******************** Start Total Time ********************/
     t1 = currentTime();
 
     /******************** Send Exchange ********************/
-    soc.send((DHEncPacket *)&encPacket, sizeof(DHEncPacket));
+    sendTimed(body, bodySize, processingTime2);
 
     /******************** Verbose ********************/
-    if (VERBOSE)
-        send_dh_verbose(&dhPackage, sequence, encPacket.getTP());
+    if (Policy::verbose)
+        send_dh_verbose(&dhPackage, sequence, processingTime2);
 
-    /******************** Memory Release ********************/
-    delete[] encryptedHash;
-    delete[] encryptedExchange;
+    /******************** Step Time ********************/
+    markStep(6);
 
     recv_dh();
 }
@@ -533,16 +729,17 @@ void AuthServer::send_dh()
 
 /*  Step 7
     Recebe os dados Diffie-Hellman vindos do Cliente.   */
-void AuthServer::recv_dh()
+template <typename Policy>
+void BasicAuthServer<Policy>::recv_dh()
 {
     /******************** Recv Enc Packet ********************/
-    DHEncPacket encPacket;
-    int recv = soc.recv(&encPacket, sizeof(DHEncPacket));
+    byte datagram[wire::size<DHEncPacket>()];
+    int recv = soc->recv(datagram, sizeof(datagram));
 
     if (recv > 0)
     {
 
-        if (isDisconnectRequest(encPacket))
+        if (isDisconnectRequest(datagram))
         {
             rdisconnect();
         }
@@ -552,66 +749,74 @@ void AuthServer::recv_dh()
             t2 = currentTime();
             totalTime = elapsedTime(t1, t2);
 
+            if (Policy::metrics)
+                metrics::record(metrics::TOTAL_TIME_DH, totalTime);
+
             /******************** Time of Proof ********************/
-            // double limit = networkTime + processingTime2*2;
-            double limit = 4000;
+            double limit = limits::dh(peer);
 
             if (totalTime <= limit)
             {
                 /******************** Decrypt Exchange ********************/
+                DHEncPacket encPacket;
+                wire::decode(datagram, encPacket);
+
                 DHKeyExchange dhKeyExchange;
                 int *const encryptedExchange = encPacket.getEncryptedExchange();
-                byte *const dhExchangeBytes = iotAuth.decryptRSA(encryptedExchange, rsaStorage->getMyPrivateKey(), sizeof(DHKeyExchange));
+                byte *const dhExchangeBytes = iotAuth.decryptRSA(encryptedExchange, rsaStorage->getMyPrivateKey(), wire::size<DHKeyExchange>());
 
-                BytesToObject(dhExchangeBytes, dhKeyExchange, sizeof(DHKeyExchange));
-                delete[] dhExchangeBytes;
+                wire::decode(dhExchangeBytes, dhKeyExchange);
 
                 /******************** Get DH Package ********************/
                 DiffieHellmanPackage dhPackage = dhKeyExchange.getDiffieHellmanPackage();
 
                 /******************** Decrypt Hash ********************/
-                string decryptedHash = decryptHash(dhKeyExchange.getEncryptedHash());
+                byte *const decryptedHash = decryptHash(dhKeyExchange.getEncryptedHash());
 
                 /******************** Validity ********************/
-                string dhString = dhPackage.toString();
-                const bool isHashValid = iotAuth.isHashValid(&dhString, &decryptedHash);
-                const bool isNonceTrue = strcmp(dhPackage.getNonceB(), nonceB) == 0;
+                const bool isHashValid = iotAuth.isHashValid(&dhPackage, decryptedHash);
+                const bool isNonceTrue = dhPackage.getNonceB() == nonceB;
 
                 if (isHashValid && isNonceTrue)
                 {
+                    limits::learnDH(peer, totalTime);
+
                     /******************** Store Nounce A ********************/
                     storeNonceA(dhPackage.getNonceA());
                     /******************** Calculate Session Key ********************/
                     diffieHellmanStorage->setSessionKey(diffieHellmanStorage->calculateSessionKey(dhPackage.getResult()));
 
-                    if (VERBOSE)
+                    if (Policy::verbose)
                         recv_dh_verbose(&dhPackage, diffieHellmanStorage->getSessionKey(), isHashValid, isNonceTrue);
 
+                    /******************** Step Time ********************/
+                    markStep(7);
+
                     send_dh_ack();
                 }
                 else if (!isHashValid)
                 {
-                    disconnect();
+                    reject();
                     throw HASH_INVALID;
                 }
                 else
                 {
-                    disconnect();
+                    reject();
                     throw NONCE_INVALID;
                 }
             }
             else
             {
-                if (VERBOSE)
+                if (Policy::verbose)
                     time_limit_burst_verbose();
-                disconnect();
+                reject();
                 throw TIMEOUT;
             }
         }
     }
     else
     {
-        if (VERBOSE)
+        if (Policy::verbose)
             response_timeout_verbose();
         throw NO_REPLY;
     }
@@ -623,33 +828,50 @@ void AuthServer::recv_dh()
 /*  Step 8
     Envia confirmação para o Cliente referente ao recebimento dos dados Diffie-Hellman.
 */
-void AuthServer::send_dh_ack()
+template <typename Policy>
+void BasicAuthServer<Policy>::send_dh_ack()
 {
     /******************** Mount ACK ********************/
     DH_ACK ack;
     ack.message = ACK;
-    strncpy(ack.nonce, nonceA, sizeof(ack.nonce));
+    ack.nonce = nonceA;
+
+    /******************** Session Ticket ********************/
+    if (Policy::tickets)
+    {
+        ack.ticket = tickets::issue(diffieHellmanStorage->getSessionKey(), diffieHellmanStorage->getIV());
+        sessions::store(ack.ticket, diffieHellmanStorage->getSessionKey(), diffieHellmanStorage->getIV());
+    }
 
     // /******************** Serialize ACK ********************/
-    byte *const ackBytes = new byte[sizeof(DH_ACK)];
-    ObjectToBytes(ack, ackBytes, sizeof(DH_ACK));
+    byte *const ackBytes = iotAuth.arena.array<byte>(wire::size<DH_ACK>());
+    wire::encode(ack, ackBytes);
 
     /******************** Encrypt ACK ********************/
-    int *const encryptedAck = iotAuth.encryptRSA(ackBytes, rsaStorage->getMyPrivateKey(), sizeof(DH_ACK));
-    delete[] ackBytes;
+    int *const encryptedAck = iotAuth.encryptRSA(ackBytes, rsaStorage->getMyPrivateKey(), wire::size<DH_ACK>());
 
     /******************** Send ACK ********************/
-    soc.send((int *)encryptedAck, sizeof(DH_ACK) * sizeof(int));
+    /* Um inteiro por byte do ACK codificado. */
+    byte datagram[wire::size<DH_ACK>() * wire::size<int>()];
+    wire::encode(encryptedAck, wire::size<DH_ACK>(), datagram);
+    soc->send(datagram, sizeof(datagram));
 
-    delete[] encryptedAck;
 
     /******************** Verbose ********************/
-    if (VERBOSE)
+    if (Policy::verbose)
         send_dh_ack_verbose(&ack);
 
     connected = true;
 
-    delete rsaStorage;
+    /******************** Step Time ********************/
+    markStep(8);
+
+    /******************** Metrics ********************/
+    if (Policy::metrics)
+    {
+        metrics::record(metrics::HANDSHAKE_TIME, elapsedTime(start, currentTime()));
+        metrics::count(OK);
+    }
 }
 
 
@@ -660,38 +882,39 @@ void AuthServer::send_dh_ack()
     fim de conexão enviado pelo Servidor (DONE_ACK).
     Em caso positivo, altera o estado para HELLO, senão, mantém em WDC. 7
 */
-status AuthServer::wdc()
+template <typename Policy>
+status BasicAuthServer<Policy>::wdc()
 {
     char message[2];
-    int count = COUNT;
+    int count = Policy::retries;
     int recv = 0;
 
     do {
-        recv = soc.recv(message, sizeof(message));
+        recv = soc->recv(message, sizeof(message));
     } while (recv <= 0 && count--);
 
     if (recv > 0)
     {
         if (message[0] == DONE_ACK_CHAR)
         {
-            if (VERBOSE)
+            if (Policy::verbose)
                 wdc_verbose();
 
             connected = false;
-            soc.finish();
+            soc->finish();
             return OK;
         }
         else
         {
             connected = false;
-            soc.finish();
+            soc->finish();
             return DENIED;
         }
     }
     else
     {
         connected = false;
-        soc.finish();
+        soc->finish();
         return NO_REPLY;
     }
 }
@@ -703,37 +926,55 @@ status AuthServer::wdc()
     Envia uma confirmação (DONE_ACK) para o pedido de término de conexão
     vindo do Cliente, e fecha o socket.
 */
-void AuthServer::rdisconnect()
+template <typename Policy>
+void BasicAuthServer<Policy>::rdisconnect()
 {
     int sent = 0;
 
     do
     {
-        sent = soc.send(DONE_ACK, strlen(DONE_ACK));
+        sent = soc->send(DONE_ACK, strlen(DONE_ACK));
     } while (sent <= 0);
 
     connected = false;
 
-    if (VERBOSE)
+    if (Policy::verbose)
         rft_verbose();
 
-    soc.finish();
+    soc->finish();
+}
+
+
+
+
+/*  Recusa o handshake em andamento: avisa o Cliente com um DONE, para
+    que ele não espere o timeout. Não espera o DONE_ACK, que recv_syn()
+    descarta se chegar: um RSA forjado não prende o Servidor.
+*/
+template <typename Policy>
+void BasicAuthServer<Policy>::reject()
+{
+    soc->send(DONE_MESSAGE, sizeof(DONE_MESSAGE));
+
+    if (Policy::verbose)
+        done_verbose();
 }
 
 
 
 
 /*  Envia um pedido de fim de conexão para o Cliente. */
-status AuthServer::done()
+template <typename Policy>
+status BasicAuthServer<Policy>::done()
 {
     int sent = 0;
     
     do
     {
-        sent = soc.send(DONE_MESSAGE, sizeof(DONE_MESSAGE));
+        sent = soc->send(DONE_MESSAGE, sizeof(DONE_MESSAGE));
     } while (sent <= 0);
 
-    if (VERBOSE)
+    if (Policy::verbose)
         done_verbose();
 
     return wdc();
@@ -743,18 +984,24 @@ status AuthServer::done()
 
 
 /*  Realiza a conexão com o Cliente. */
-status AuthServer::connect()
+template <typename Policy>
+status BasicAuthServer<Policy>::connect()
 {
-    soc.connect();
+    /* A sessão anterior já terminou: sua memória é devolvida de uma vez. */
+    release();
+
+    soc->connect();
 
     /* Set maximum wait time for response */
-    soc.max_response_time(TIMEOUT_SEC, TIMEOUT_MIC);
+    soc->max_response_time(Policy::timeoutSec, Policy::timeoutMic);
 
     /* Get IP Address Server */
-    serverIP = soc.server_address();
+    serverIP = soc->server_address();
 
     /* Get IP Address Client */
-    clientIP = soc.client_address();
+    clientIP = soc->client_address();
+
+    status result = OK;
 
     try
     {
@@ -762,23 +1009,72 @@ status AuthServer::connect()
     }
     catch (status e)
     {
-        reply_verbose(e);
-        return e;
+        if (Policy::verbose)
+            reply_verbose(e);
+        if (Policy::trace)
+            trace::record(trace::SERVER, trace::FAIL, session, e);
+        if (Policy::metrics)
+            metrics::count(e);
+
+        /* Libera o socket para que a próxima espera consiga abri-lo novamente. */
+        soc->finish();
+        result = e;
+    }
+
+    /* Terminado ou não, o handshake deixa de contar no limite de simultâneos. */
+    if (admitted)
+    {
+        admission::end();
+        admitted = false;
     }
 
-    return OK;
+    return result;
+}
+
+
+
+
+/*  Decide se o datagrama do endereço atual (peer) segue para o handshake.
+    Um RSA também precisa de uma vaga entre os handshakes em andamento.
+*/
+template <typename Policy>
+bool BasicAuthServer<Policy>::admit(bool handshake)
+{
+    if (!Policy::admission)
+        return true;
+
+    if (!admission::admit(peer))
+    {
+        if (Policy::metrics)
+            metrics::shed(metrics::SHED_RATE);
+        return false;
+    }
+
+    if (handshake)
+    {
+        if (!admission::begin())
+        {
+            if (Policy::metrics)
+                metrics::shed(metrics::SHED_BUSY);
+            return false;
+        }
+        admitted = true;
+    }
+
+    return true;
 }
 
 
 
 
 /*  Envia ACK confirmando o recebimento da publicação. */
-bool AuthServer::sack()
+template <typename Policy>
+bool BasicAuthServer<Policy>::sack()
 {
     char ack = ACK_CHAR;
-    uint8_t sent = soc.send(&ack, sizeof(ack));
+    uint8_t sent = soc->send(&ack, sizeof(ack));
 
-    if (send > 0)
+    if (sent > 0)
     {
         return true;
     }
@@ -789,18 +1085,19 @@ bool AuthServer::sack()
 
 
 /*  Recebe ACK confirmando o recebimento da publicação. */
-bool AuthServer::rack()
+template <typename Policy>
+bool BasicAuthServer<Policy>::rack()
 {
     char ack = 'a';
-    int count = COUNT;
-    int recv;
+    int count = Policy::retries;
+    int recv = 0;
 
     while ((recv <= 0 || ack != ACK_CHAR) && count--)
     {
-        recv = soc.recv(&ack, sizeof(ack));
+        recv = soc->recv(&ack, sizeof(ack));
     }
 
-    if (ack == ACK)
+    if (ack == ACK_CHAR)
     {
         return true;
     } 
@@ -811,8 +1108,9 @@ bool AuthServer::rack()
 
 
 /*  Verifica se a mensagem recebida é um pedido de desconexão. */
+template <typename Policy>
 template <typename T>
-bool AuthServer::isDisconnectRequest(T &object)
+bool BasicAuthServer<Policy>::isDisconnectRequest(T &object)
 {
     int cmp = memcmp(&object, DONE_MESSAGE, strlen(DONE_MESSAGE));
     return cmp == 0;
@@ -822,43 +1120,33 @@ bool AuthServer::isDisconnectRequest(T &object)
 
 
 /*  Armazena o valor do nonce B em uma variável global. */
-void AuthServer::storeNonceA(char *nonce)
+template <typename Policy>
+void BasicAuthServer<Policy>::storeNonceA(Nonce nonce)
 {
-    strncpy(nonceA, nonce, sizeof(nonceA));
+    nonceA = nonce;
 }
 
 
 
 
 /*  Gera um valor para o nonce B.   */
-void AuthServer::generateNonce(char *nonce)
+template <typename Policy>
+void BasicAuthServer<Policy>::generateNonce(Nonce *nonce)
 {
-    string message = stringTime() + *serverIP + *clientIP + to_string(sequence++);
-    string hash = iotAuth.hash(&message);
-
-    memset(nonce, '\0', 129);
-    strncpy(nonce, hash.c_str(), 128);
+    sequence++;
+    csprng::fill(nonce->bytes, NONCE_SIZE);
 }
 
 
 
 
-/*  Decifra o hash utilizando a chave pública do Cliente. */
-string AuthServer::decryptHash(int *encryptedHash)
+/*  Decifra o hash utilizando a chave pública do Cliente.
+    Os IotAuth::HASH_SIZE bytes ficam na arena da sessão.
+*/
+template <typename Policy>
+byte *BasicAuthServer<Policy>::decryptHash(int *encryptedHash)
 {
-    byte *decryptedHash = iotAuth.decryptRSA(encryptedHash, rsaStorage->getPartnerPublicKey(), 128);
-
-    char aux;
-    string decryptedHashString = "";
-    for (int i = 0; i < 128; i++)
-    {
-        aux = decryptedHash[i];
-        decryptedHashString += aux;
-    }
-
-    delete[] decryptedHash;
-
-    return decryptedHashString;
+    return iotAuth.decryptRSA(encryptedHash, rsaStorage->getPartnerPublicKey(), IotAuth::HASH_SIZE);
 }
 
 
@@ -867,9 +1155,10 @@ string AuthServer::decryptHash(int *encryptedHash)
 /*  Inicializa os valores pertinentes a troca de chaves Diffie-Hellman:
     expoente, base, módulo, resultado e a chave de sessão.
 */
-void AuthServer::generateDiffieHellman()
+template <typename Policy>
+void BasicAuthServer<Policy>::generateDiffieHellman()
 {
-    diffieHellmanStorage = new DHStorage();
+    diffieHellmanStorage = iotAuth.arena.make<DHStorage>();
     diffieHellmanStorage->setBase(iotAuth.randomNumber(100) + 2);
     diffieHellmanStorage->setExponent(iotAuth.randomNumber(3) + 2);
     diffieHellmanStorage->setModulus(iotAuth.randomNumber(100) + 2);
@@ -878,33 +1167,72 @@ void AuthServer::generateDiffieHellman()
 
 
 
-/*  Cifra a mensagem utilizando o algoritmo AES 256 e a chave de sessão. */
-string AuthServer::encryptMessage(char *message, int size)
+/*  Libera de uma vez a memória da sessão (storages e buffers do RSA). */
+template <typename Policy>
+void BasicAuthServer<Policy>::release()
 {
-    /* Inicialização do vetor plaintext. */
-    uint8_t plaintext[size];
-    memset(plaintext, 0, size);
+    iotAuth.arena.reset();
+    rsaStorage = NULL;
+    diffieHellmanStorage = NULL;
+}
+
+
+
+
+/*  Cifra os 'length' primeiros bytes da mensagem, completada com zeros até
+    'size' bytes e um múltiplo do bloco AES, com a chave de sessão. O texto
+    cifrado é montado no próprio datagrama, já em hexadecimal, e o tamanho
+    a enviar é retornado.
+*/
+template <typename Policy>
+int BasicAuthServer<Policy>::encryptMessage(const char *message, int length, int size, Datagram *datagram)
+{
+    const int padded = (size + AES_BLOCKLEN - 1) / AES_BLOCKLEN * AES_BLOCKLEN;
+
+    uint8_t *const plaintext = datagram->bytes;
+    memcpy(plaintext, message, length);
+    memset(plaintext + length, 0, padded - length);
 
     /* Inicialização da chave e do IV. */
-    uint8_t key[32];
-    for (int i = 0; i < 32; i++)
-    {
-        key[i] = diffieHellmanStorage->getSessionKey();
-    }
+    uint8_t key[AES<Policy::aesKeyBits>::KEYLEN];
+    memset(key, diffieHellmanStorage->getSessionKey(), sizeof(key));
 
     uint8_t iv[16];
-    for (int i = 0; i < 16; i++)
-    {
-        iv[i] = diffieHellmanStorage->getIV();
-    }
+    memset(iv, diffieHellmanStorage->getIV(), sizeof(iv));
 
-    /* Converte o array de char (message) para uint8_t. */
-    CharToUint8_t(message, plaintext, size);
+    /* Cifra e codifica no mesmo buffer. */
+    iotAuth.encryptAES<Policy::aesKeyBits>(plaintext, key, iv, padded);
+    BytesToHexStringInPlace(datagram->bytes, padded);
 
-    /* Encripta a mensagem utilizando a chave e o iv declarados anteriormente. */
-    uint8_t *const encrypted = iotAuth.encryptAES(plaintext, key, iv, size);
+    datagram->size = 2 * padded;
+    return datagram->size;
+}
 
-    const string result = Uint8_tToHexString(encrypted, size);
 
-    return result;
-}
\ No newline at end of file
+
+
+/*  Junta o corpo da mensagem e o tempo de processamento na saída
+    (sendmsg): o corpo é codificado antes do início do tempo total e só os
+    8 bytes do tempo ficam para depois, sem copiar a mensagem inteira.
+*/
+template <typename Policy>
+int BasicAuthServer<Policy>::sendTimed(const byte *body, size_t size, double processingTime)
+{
+    byte time[wire::size<double>()];
+    wire::encode(processingTime, time);
+
+    struct iovec parts[2];
+    parts[0].iov_base = (void *)body;
+    parts[0].iov_len = size;
+    parts[1].iov_base = time;
+    parts[1].iov_len = sizeof(time);
+
+    return soc->sendv(parts, 2);
+}
+
+
+
+
+/*  Políticas disponíveis; uma política nova precisa ser instanciada aqui. */
+template class BasicAuthServer<DefaultPolicy>;
+template class BasicAuthServer<QuietPolicy>;
\ No newline at end of file
@@ -18,22 +18,45 @@
 #include "../Diffie-Hellman/DHEncPacket.h"
 
 #include "../verbose/verbose_server.h"
+#include "../trace/trace.h"
+#include "../metrics/metrics.h"
+#include "TimeLimits.h"
+#include "SessionTicket.h"
+#include "SessionCache.h"
+#include "SynCookie.h"
+#include "Admission.h"
+#include "Policy.h"
 
 #include "../Socket/UDPSocket.h"
+#include "../Socket/DatagramPool.h"
 
 using namespace std;
 
-class AuthServer
+/*  Servidor configurado em tempo de compilação pela política (Policy.h). */
+template <typename Policy>
+class BasicAuthServer
 {
   public:
 
-    AuthServer();
+    BasicAuthServer();
+
+    /*  Utiliza o transporte informado no lugar do socket UDP padrão. */
+    BasicAuthServer(Transport *transport);
 
     /*  Aguarda conexão com algum Cliente. */
     bool wait_connection();
 
     /*  Entra em estado de espera por dados vindos do Cliente. */
     string listen();
+
+    /*  Recebe uma mensagem do Cliente e a decifra no próprio buffer do
+        datagrama, sem cópias intermediárias. O conteúdo vale até release();
+        data é NULL se o Cliente encerrou a conexão ou a mensagem era inválida.
+    */
+    Received receive();
+
+    /*  Devolve ao pool o datagrama de uma mensagem recebida. */
+    void release(Received &message);
     
     /*  Envia dados para o Cliente. */
     status publish(char *data);
@@ -47,29 +70,40 @@ class AuthServer
     
   private:
 
-    RSAStorage *rsaStorage;
-    DHStorage *diffieHellmanStorage;
+    RSAStorage *rsaStorage = NULL;          /*  Ambos vivem na arena do iotAuth. */
+    DHStorage *diffieHellmanStorage = NULL;
     IotAuth iotAuth;
+    DatagramPool datagrams;     /*  Buffers das mensagens recebidas e publicadas. */
 
-    UDPSocket soc;
+    UDPSocket udpSocket;
+    Transport *soc;
     
     char *serverIP;
     char *clientIP;
     int sequence;
-    char nonceA[129];
-    char nonceB[129];
+    Nonce nonceA;
+    Nonce nonceB;
 
     double networkTime, processingTime1, processingTime2, tp, auxiliarTime, totalTime;
     double t1, t2;
     double t_aux1, t_aux2;
     double start;
+    uint32_t session = 0;   /*  Identificador do handshake atual no trace. */
+    uint32_t peer = 0;      /*  IPv4 do Cliente, para os limites por segmento. */
+    bool admitted = false;  /*  Ocupa uma vaga de handshake em andamento (Auth/Admission). */
 
     char buffer[666];
 
     bool connected = false;
 
+    /*  Registra o fim do Step informado (0 para o início do handshake) no trace. */
+    void markStep(int step);
+
     /*  Step 1
         Recebe um pedido de início de conexão por parte do Cliente.
+        O ACK leva um cookie e o Servidor volta a esperar: SYNs são respondidos
+        sem guardar estado, e o handshake só começa quando chega um RSA com um
+        cookie válido (Step 3).
     */
     void recv_syn();
 
@@ -78,10 +112,19 @@ class AuthServer
     */
     void send_ack();
 
+    /*  Resume
+        Retoma a sessão do ticket recebido no SYN, no lugar dos Steps 2 a 8.
+        Retorna false se o ticket ou a prova forem inválidos, e o handshake
+        segue completo.
+    */
+    bool send_resume_ack(structResume *received);
+
     /*  Step 3
         Recebe os dados RSA vindos do Cliente.
+        Só aqui o handshake passa a ter estado: o cookie devolvido no nonce B
+        precisa ser válido para o endereço e o nonce A do Cliente.
     */
-    void recv_rsa();
+    void recv_rsa(RSAKeyExchange *rsaReceived);
 
     /*  Step 4
         Realiza o envio dos dados RSA para o Cliente.
@@ -122,8 +165,18 @@ class AuthServer
     /*  Envia um pedido de fim de conexão para o Cliente. */
     status done();
 
+    /*  Recusa o handshake em andamento: envia um DONE ao Cliente, que
+        ainda não está conectado, sem esperar a confirmação.
+    */
+    void reject();
+
     /*  Realiza a conexão com o Cliente. */
     status connect();
+
+    /*  Decide se o datagrama do endereço atual (peer) segue para o handshake.
+        Um RSA também precisa de uma vaga entre os handshakes em andamento.
+    */
+    bool admit(bool handshake);
     
     /*  Envia ACK confirmando o recebimento da publicação. */
     bool sack();
@@ -136,21 +189,40 @@ class AuthServer
     bool isDisconnectRequest(T &object);
 
     /*  Armazena o valor do nonce B em uma variável global. */
-    void storeNonceA(char *nonce);
+    void storeNonceA(Nonce nonce);
 
     /*  Gera um valor para o nonce B.   */
-    void generateNonce(char *nonce);
+    void generateNonce(Nonce *nonce);
 
-    /*  Decifra o hash utilizando a chave pública do Cliente. */
-    string decryptHash(int *encryptedHash);
+    /*  Decifra o hash utilizando a chave pública do Cliente.
+        Os IotAuth::HASH_SIZE bytes ficam na arena da sessão.
+    */
+    byte *decryptHash(int *encryptedHash);
 
     /*  Inicializa os valores pertinentes à troca de chaves Diffie-Hellman:
         expoente, base, módulo, resultado e a chave de sessão. 
     */
     void generateDiffieHellman();
 
-    /*  Cifra a mensagem utilizando o algoritmo AES 256 e a chave de sessão. */
-    string encryptMessage(char *message, int size);
+    /*  Libera de uma vez a memória da sessão (storages e buffers do RSA). */
+    void release();
+
+    /*  Cifra os 'length' primeiros bytes de dados em uma mensagem de 'size'
+        bytes e a envia ao Cliente, sem alocação nem cópias intermediárias.
+    */
+    status publishMessage(const char *data, int length, int size);
+
+    /*  Cifra a mensagem com a chave de sessão no próprio datagrama, já em
+        hexadecimal, e retorna o tamanho a enviar.
+    */
+    int encryptMessage(const char *message, int length, int size, Datagram *datagram);
+
+    /*  Envia os 'size' bytes do corpo já codificado e o tempo de
+        processamento, último campo da mensagem, como um só datagrama.
+    */
+    int sendTimed(const byte *body, size_t size, double processingTime);
 };
 
+typedef BasicAuthServer<DefaultPolicy> AuthServer;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "../settings.h"
+
+/*  Políticas de configuração do Servidor e do Cliente (BasicAuthServer e
+    BasicAuthClient). Cada membro é uma constante de compilação: os ramos
+    desligados somem do código gerado, e endpoints com políticas
+    diferentes convivem no mesmo processo. Uma política nova herda de
+    DefaultPolicy, redefine o que muda e é instanciada no fim de
+    AuthServer.cpp e AuthClient.cpp.
+*/
+
+/*  Valores de settings.h, que continuam podendo ser redefinidos na
+    compilação (ex.: -DVERBOSE=false).
+*/
+struct DefaultPolicy
+{
+    static constexpr bool verbose = VERBOSE;        /* Saída detalhada de cada Step no console. */
+    static constexpr bool trace = TRACE;            /* Eventos binários (trace/). */
+    static constexpr bool metrics = METRICS;        /* Histogramas dos tempos do handshake (metrics/). */
+    static constexpr bool tickets = TICKETS;        /* Retomada de sessão com tickets. */
+    static constexpr bool admission = ADMISSION;    /* Controle de admissão do Servidor. */
+    static constexpr int cryptoWorkers = CRYPTO_WORKERS; /* Threads do RSA do Servidor, iniciadas na sua criação. */
+
+    static constexpr int retries = COUNT;           /* Tentativas de recebimento de publicações e ACKs. */
+    static constexpr int timeoutSec = TIMEOUT_SEC;  /* Espera máxima por uma resposta. */
+    static constexpr int timeoutMic = TIMEOUT_MIC;
+    static constexpr int port = DEFAULT_PORT;       /* Porta padrão do Cliente. */
+    static constexpr int aesKeyBits = AES_KEY_BITS; /* AES das publicações: 128, 192 ou 256. */
+};
+
+/*  Sem saída no console, qualquer que seja VERBOSE: usada pelos benchmarks. */
+struct QuietPolicy : DefaultPolicy
+{
+    static constexpr bool verbose = false;
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include "SessionCache.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <mutex>
+
+#include "../SHA/sha512.h"
+#include "../utils.h"
+
+namespace sessions
+{
+
+#define CACHE_MAGIC "GWCACHE1"
+#define CACHE_VERSION 2
+
+enum
+{
+    EMPTY = 0,
+    USED = 1,
+    DELETED = 2,    /* Mantém a sequência de sondagem de outras sessões. */
+};
+
+typedef struct header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t slots;
+    uint64_t reserved;
+} Header;
+
+typedef struct slot
+{
+    uint64_t id;
+    uint8_t check[32];  /* Restante do hash do ticket: confirma que é o mesmo ticket. */
+    int32_t sessionKey; /* Mascarados (Digest::mask). */
+    int32_t iv;
+    int64_t expires;    /* Relógio de parede, em segundos: precisa valer após reiniciar. */
+    uint32_t state;     /* Escrito por último, para que um slot pela metade nunca pareça USED. */
+    uint32_t reserved;
+} Slot;
+
+static std::mutex lock;
+static void *mapping = NULL;
+static size_t mappingSize = 0;
+static Slot *slots = NULL;
+
+static const uint64_t mask = SESSION_SLOTS - 1;
+
+static bool valid(const Header *header)
+{
+    return memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) == 0 && header->version == CACHE_VERSION &&
+           header->slotSize == sizeof(Slot) && header->slots == SESSION_SLOTS;
+}
+
+bool open(const char *path)
+{
+    static_assert((SESSION_SLOTS & (SESSION_SLOTS - 1)) == 0, "SESSION_SLOTS must be a power of 2");
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (mapping != NULL)
+        return false;
+
+    const int fd = ::open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0)
+        return false;
+
+    const size_t size = sizeof(Header) + SESSION_SLOTS * sizeof(Slot);
+
+    struct stat info;
+    const bool fresh = fstat(fd, &info) < 0 || (size_t)info.st_size != size;
+
+    /* Um arquivo de outro tamanho é descartado: os slots não seriam os mesmos. */
+    if (fresh && (ftruncate(fd, 0) < 0 || ftruncate(fd, size) < 0))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+        return false;
+
+    Header *header = (Header *)memory;
+    if (fresh || !valid(header))
+    {
+        memset(memory, 0, size);
+        memcpy(header->magic, CACHE_MAGIC, sizeof(header->magic));
+        header->version = CACHE_VERSION;
+        header->slotSize = sizeof(Slot);
+        header->slots = SESSION_SLOTS;
+    }
+
+    mapping = memory;
+    mappingSize = size;
+    slots = (Slot *)(header + 1);
+    return true;
+}
+
+void close()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (mapping == NULL)
+        return;
+
+    munmap(mapping, mappingSize);
+    mapping = NULL;
+    slots = NULL;
+}
+
+/*  SHA-512 do ticket inteiro, na codificação da rede, dividido em usos. */
+typedef struct digest
+{
+    uint64_t id;
+    uint8_t check[32];
+    int32_t mask[2];
+} Digest;
+
+static Digest digest(const Ticket &ticket)
+{
+    static_assert(sizeof(Digest) <= SHA512::DIGEST_SIZE, "Digest must fit in a SHA-512");
+
+    uint8_t bytes[wire::size<Ticket>()];
+    wire::encode(ticket, bytes);
+
+    uint8_t hash[SHA512::DIGEST_SIZE];
+    SHA512 sha;
+    sha.init();
+    sha.update((const uint8_t *)"GWSC", 4);
+    sha.update(bytes, sizeof(bytes));
+    sha.final(hash);
+
+    Digest d;
+    memcpy(&d, hash, sizeof(d));
+    return d;
+}
+
+void store(const Ticket &ticket, int sessionKey, int iv)
+{
+    const Digest d = digest(ticket);
+    const uint64_t id = d.id;
+    const int64_t now = time(NULL);
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (slots == NULL)
+        return;
+
+    /* Primeiro slot livre ou expirado; sem nenhum, o que expira antes. */
+    Slot *target = NULL;
+    for (uint64_t i = 0; i < SESSION_PROBES; i++)
+    {
+        Slot *slot = &slots[(id + i) & mask];
+        if (slot->state != USED || slot->expires <= now)
+        {
+            target = slot;
+            break;
+        }
+        if (target == NULL || slot->expires < target->expires)
+            target = slot;
+    }
+
+    target->state = DELETED;
+    target->id = id;
+    memcpy(target->check, d.check, sizeof(target->check));
+    target->sessionKey = sessionKey ^ d.mask[0];
+    target->iv = iv ^ d.mask[1];
+    target->expires = now + 2 * TICKET_ROTATION;
+    target->state = USED;
+}
+
+/* Slot da sessão, ou NULL. Chamado com o lock. */
+static Slot *lookup(const Digest &d)
+{
+    if (slots == NULL)
+        return NULL;
+
+    for (uint64_t i = 0; i < SESSION_PROBES; i++)
+    {
+        Slot *slot = &slots[(d.id + i) & mask];
+        if (slot->state == EMPTY)
+            return NULL;
+        if (slot->state == USED && slot->id == d.id && constantTimeEquals(slot->check, d.check, sizeof(d.check)))
+            return slot;
+    }
+    return NULL;
+}
+
+bool find(const Ticket &ticket, int *sessionKey, int *iv)
+{
+    const Digest d = digest(ticket);
+
+    std::lock_guard<std::mutex> guard(lock);
+    const Slot *slot = lookup(d);
+    if (slot == NULL || slot->expires <= time(NULL))
+        return false;
+
+    *sessionKey = slot->sessionKey ^ d.mask[0];
+    *iv = slot->iv ^ d.mask[1];
+    return true;
+}
+
+void erase(const Ticket &ticket)
+{
+    const Digest d = digest(ticket);
+
+    std::lock_guard<std::mutex> guard(lock);
+    Slot *slot = lookup(d);
+    if (slot != NULL)
+        slot->state = DELETED;
+}
+
+}
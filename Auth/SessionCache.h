@@ -0,0 +1,39 @@
+#ifndef SESSION_CACHE_H
+#define SESSION_CACHE_H
+
+#include <stdint.h>
+
+#include "../settings.h"
+
+/*  Cache persistente de sessões do Servidor.
+    Um arquivo mapeado em memória com SESSION_SLOTS slots de tamanho fixo,
+    indexados por endereçamento aberto. Cada sessão retomável fica guardada
+    sob o hash do ticket inteiro que o Cliente recebeu: só quem apresenta
+    exatamente esse ticket a encontra, e a chave de sessão e o IV ficam
+    mascarados com outra parte do hash, de modo que o arquivo sozinho não
+    os revela. Assim, um Servidor reiniciado, que perdeu as chaves de
+    tickets, ainda retoma as sessões existentes em vez de receber todos os
+    handshakes completos de uma vez. Global ao processo; desativado até
+    open().
+*/
+namespace sessions
+{
+
+/*  Abre (ou cria) o cache no arquivo informado. */
+bool open(const char *path);
+
+/*  Desfaz o mapeamento; as sessões continuam no arquivo. */
+void close();
+
+/*  Guarda a sessão do ticket por até 2 * TICKET_ROTATION segundos. */
+void store(const Ticket &ticket, int sessionKey, int iv);
+
+/*  Procura a sessão ainda válida do ticket. */
+bool find(const Ticket &ticket, int *sessionKey, int *iv);
+
+/*  Remove a sessão; cada sessão é retomada uma única vez. */
+void erase(const Ticket &ticket);
+
+}
+
+#endif
@@ -0,0 +1,201 @@
+#include "SessionTicket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+#include "../AES/AES.h"
+#include "../SHA/Canonical.h"
+#include "../time.h"
+#include "../utils.h"
+
+namespace tickets
+{
+
+/* Conteúdo selado de um ticket: exatamente um bloco AES. */
+typedef struct contents
+{
+    int32_t sessionKey;
+    int32_t iv;
+    uint32_t salt[2];
+} Contents;
+
+typedef struct key
+{
+    uint32_t id = 0;
+    uint8_t aes[AES128::KEYLEN];
+    uint8_t mac[32];
+    double created = 0;
+} Key;
+
+static std::mutex lock;
+static Key current, previous;
+static uint32_t lastId = 0;
+
+/*  Tickets já retomados, pelo início do MAC, até deixarem de ser aceitos
+    (2 * TICKET_ROTATION). Como o prazo é fixo, a fila fica ordenada por
+    expiração.
+*/
+static std::unordered_set<uint64_t> redeemed;
+static std::deque<std::pair<double, uint64_t>> expiring;
+
+/* Chamado com o lock. */
+static void rotateLocked()
+{
+    previous = current;
+
+    current.id = ++lastId;
+    randomBytes(current.aes, sizeof(current.aes));
+    randomBytes(current.mac, sizeof(current.mac));
+    current.created = currentTime();
+}
+
+/* Chave atual, trocada quando passa de TICKET_ROTATION segundos. */
+static Key sealingKey()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (current.id == 0 || currentTime() - current.created >= TICKET_ROTATION)
+        rotateLocked();
+    return current;
+}
+
+/* Chave que selou o ticket, se ainda aceita. */
+static bool openingKey(uint32_t id, Key *key)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (current.id != 0 && currentTime() - current.created >= TICKET_ROTATION)
+        rotateLocked();
+
+    /* A anterior vale apenas até completar a segunda rotação. */
+    if (id != 0 && id == current.id)
+        *key = current;
+    else if (id != 0 && id == previous.id && currentTime() - previous.created < 2 * TICKET_ROTATION)
+        *key = previous;
+    else
+        return false;
+    return true;
+}
+
+static void authenticate(const Key &key, const Ticket &ticket, uint8_t *mac)
+{
+    uint8_t digest[SHA512::DIGEST_SIZE];
+
+    SHA512 sha;
+    sha.init();
+    sha.update(key.mac, sizeof(key.mac));
+    sha.update((const uint8_t *)&ticket.keyId, sizeof(ticket.keyId));
+    sha.update(ticket.iv, sizeof(ticket.iv));
+    sha.update(ticket.sealed, sizeof(ticket.sealed));
+    sha.final(digest);
+
+    memcpy(mac, digest, sizeof(ticket.mac));
+}
+
+Ticket issue(int sessionKey, int iv)
+{
+    const Key key = sealingKey();
+
+    Contents contents;
+    contents.sessionKey = sessionKey;
+    contents.iv = iv;
+    randomBytes(contents.salt, sizeof(contents.salt));
+
+    Ticket ticket;
+    ticket.keyId = key.id;
+    randomBytes(ticket.iv, sizeof(ticket.iv));
+    memcpy(ticket.sealed, &contents, sizeof(ticket.sealed));
+
+    AES128 aes;
+    AES128::AES_ctx ctx;
+    aes.AES_init_ctx_iv(&ctx, key.aes, ticket.iv);
+    aes.AES_CBC_encrypt_buffer(&ctx, ticket.sealed, sizeof(ticket.sealed));
+
+    authenticate(key, ticket, ticket.mac);
+    return ticket;
+}
+
+bool open(const Ticket &ticket, int *sessionKey, int *iv)
+{
+    Key key;
+    if (!openingKey(ticket.keyId, &key))
+        return false;
+
+    uint8_t mac[sizeof(ticket.mac)];
+    authenticate(key, ticket, mac);
+    if (!constantTimeEquals(mac, ticket.mac, sizeof(mac)))
+        return false;
+
+    Contents contents;
+    memcpy(&contents, ticket.sealed, sizeof(contents));
+
+    AES128 aes;
+    AES128::AES_ctx ctx;
+    aes.AES_init_ctx_iv(&ctx, key.aes, ticket.iv);
+    aes.AES_CBC_decrypt_buffer(&ctx, (uint8_t *)&contents, sizeof(contents));
+
+    *sessionKey = contents.sessionKey;
+    *iv = contents.iv;
+    return true;
+}
+
+bool redeem(const Ticket &ticket)
+{
+    uint64_t id;
+    memcpy(&id, ticket.mac, sizeof(id));
+    const double now = currentTime();
+
+    std::lock_guard<std::mutex> guard(lock);
+    while (!expiring.empty() && expiring.front().first <= now)
+    {
+        redeemed.erase(expiring.front().second);
+        expiring.pop_front();
+    }
+
+    if (!redeemed.insert(id).second)
+        return false;
+    expiring.push_back(std::make_pair(now + 2 * TICKET_ROTATION, id));
+    return true;
+}
+
+/*  Hash da chave de sessão, do IV e dos nonces, separado pelo rótulo do uso. */
+static void digest(const char (&label)[5], int sessionKey, int iv, const Nonce &nonceA, const Nonce &nonceB,
+                   uint8_t *out)
+{
+    SHA512 sha;
+    sha.init();
+    canonical::tag(&sha, label);
+    canonical::i32(&sha, sessionKey);
+    canonical::i32(&sha, iv);
+    canonical::bytes(&sha, nonceA.bytes, NONCE_SIZE);
+    canonical::bytes(&sha, nonceB.bytes, NONCE_SIZE);
+    sha.final(out);
+}
+
+void derive(int *sessionKey, int *iv, const Nonce &nonceA, const Nonce &nonceB)
+{
+    uint8_t hash[SHA512::DIGEST_SIZE];
+    digest("DRIV", *sessionKey, *iv, nonceA, nonceB, hash);
+
+    int32_t derived[2];
+    wire::decode(hash, 2, derived);
+    *sessionKey = derived[0] & 0x7FFFFFFF;
+    *iv = derived[1] & 0x7FFFFFFF;
+}
+
+void proof(int sessionKey, int iv, const Nonce &nonceA, const Nonce &nonceB, uint8_t *out)
+{
+    uint8_t hash[SHA512::DIGEST_SIZE];
+    digest("PROF", sessionKey, iv, nonceA, nonceB, hash);
+    memcpy(out, hash, PROOF_SIZE);
+}
+
+void rotate()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    rotateLocked();
+}
+
+}
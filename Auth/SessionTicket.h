@@ -0,0 +1,40 @@
+#ifndef SESSION_TICKET_H
+#define SESSION_TICKET_H
+
+#include "../settings.h"
+
+/*  Tickets de sessão do Servidor.
+    Ao fim de um handshake completo o Servidor sela a chave de sessão e o
+    IV em um ticket, com uma chave própria que troca a cada
+    TICKET_ROTATION segundos. O Cliente o apresenta no próximo SYN e os
+    dois lados derivam chaves novas em uma única ida e volta, sem que o
+    Servidor guarde estado por Cliente. Global ao processo.
+*/
+namespace tickets
+{
+
+/*  Sela a chave de sessão e o IV em um ticket. */
+Ticket issue(int sessionKey, int iv);
+
+/*  Abre um ticket selado pela chave atual ou pela anterior.
+    Retorna false se o ticket expirou ou foi adulterado.
+*/
+bool open(const Ticket &ticket, int *sessionKey, int *iv);
+
+/*  Marca um ticket autenticado como retomado. Retorna false se ele já
+    tinha sido: cada ticket vale uma única retomada enquanto for aceito.
+*/
+bool redeem(const Ticket &ticket);
+
+/*  Substitui a chave de sessão e o IV pelos derivados dos nonces da retomada. */
+void derive(int *sessionKey, int *iv, const Nonce &nonceA, const Nonce &nonceB);
+
+/*  Prova de posse da chave de sessão, amarrada aos nonces: PROOF_SIZE bytes em 'out'. */
+void proof(int sessionKey, int iv, const Nonce &nonceA, const Nonce &nonceB, uint8_t *out);
+
+/*  Troca a chave de tickets imediatamente; a anterior continua aceita. */
+void rotate();
+
+}
+
+#endif
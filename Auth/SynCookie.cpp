@@ -0,0 +1,75 @@
+#include "SynCookie.h"
+
+#include <string.h>
+
+#include "../SHA/sha512.h"
+#include "../time.h"
+#include "../utils.h"
+
+namespace cookies
+{
+
+/* Parte do cookie em claro; o restante do nonce é o MAC. */
+typedef struct stamp
+{
+    uint64_t sent;      /* nanoTime() no envio do ACK. */
+    uint32_t session;
+} __attribute__((packed)) Stamp;
+
+#define MAC_BYTES (NONCE_SIZE - sizeof(Stamp))
+
+/* Segredo sorteado na primeira utilização; um reinício invalida os cookies pendentes. */
+static const uint8_t *secret()
+{
+    static uint8_t key[32];
+    static const bool ready = (randomBytes(key, sizeof(key)), true);
+    (void)ready;
+    return key;
+}
+
+static void authenticate(uint32_t peer, const Nonce &nonceA, const Stamp &stamp, uint8_t *mac)
+{
+    uint8_t digest[SHA512::DIGEST_SIZE];
+
+    SHA512 sha;
+    sha.init();
+    sha.update(secret(), 32);
+    sha.update((const uint8_t *)&peer, sizeof(peer));
+    sha.update((const uint8_t *)&stamp, sizeof(stamp));
+    sha.update(nonceA.bytes, NONCE_SIZE);
+    sha.final(digest);
+
+    memcpy(mac, digest, MAC_BYTES);
+}
+
+void make(uint32_t peer, const Nonce &nonceA, uint32_t session, Nonce *cookie)
+{
+    Stamp stamp;
+    stamp.sent = nanoTime();
+    stamp.session = session;
+
+    memcpy(cookie->bytes, &stamp, sizeof(stamp));
+    authenticate(peer, nonceA, stamp, cookie->bytes + sizeof(stamp));
+}
+
+bool check(uint32_t peer, const Nonce &nonceA, const Nonce &cookie, uint32_t *session, double *sent)
+{
+    /* O carimbo vem do próprio cookie; o MAC recalculado confirma que foi este Servidor quem o emitiu. */
+    Stamp stamp;
+    memcpy(&stamp, cookie.bytes, sizeof(stamp));
+
+    const uint64_t now = nanoTime();
+    if (stamp.sent > now || now - stamp.sent > (uint64_t)COOKIE_LIFETIME * 1000000000)
+        return false;
+
+    uint8_t mac[MAC_BYTES];
+    authenticate(peer, nonceA, stamp, mac);
+    if (!constantTimeEquals(mac, cookie.bytes + sizeof(stamp), MAC_BYTES))
+        return false;
+
+    *session = stamp.session;
+    *sent = stamp.sent / 1000000000.0;
+    return true;
+}
+
+}
@@ -0,0 +1,28 @@
+#ifndef SYN_COOKIE_H
+#define SYN_COOKIE_H
+
+#include <stdint.h>
+
+#include "../settings.h"
+
+/*  Cookies de SYN.
+    O nonce B do ACK é um cookie: o instante de envio e o identificador do
+    handshake no trace, seguidos de um MAC desses valores, do endereço do
+    Cliente e do nonce A, com um segredo do Servidor. O Servidor não guarda
+    nada ao responder um SYN; a sessão só começa quando o RSA do Cliente
+    devolve um cookie válido, com menos de COOKIE_LIFETIME segundos.
+*/
+namespace cookies
+{
+
+/*  Escreve em 'cookie' o cookie do SYN recebido: o carimbo seguido do MAC truncado. */
+void make(uint32_t peer, const Nonce &nonceA, uint32_t session, Nonce *cookie);
+
+/*  Valida o cookie devolvido pelo Cliente e recupera o identificador do
+    handshake e o instante (currentTime) em que o ACK foi enviado.
+*/
+bool check(uint32_t peer, const Nonce &nonceA, const Nonce &cookie, uint32_t *session, double *sent);
+
+}
+
+#endif
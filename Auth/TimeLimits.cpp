@@ -0,0 +1,178 @@
+#include "TimeLimits.h"
+
+#include <mutex>
+#include <unordered_map>
+
+#include "../metrics/histogram.h"
+
+namespace limits
+{
+
+/* Segmentos além deste número dividem uma única entrada. */
+#define MAX_SEGMENTS 64
+/* Amostras entre recálculos do quantil. */
+#define REFRESH 32
+
+/*  Latências de uma prova de tempo em um segmento.
+    Duas janelas: ao encher a atual, a anterior é descartada e as duas
+    trocam de papel, de modo que mudanças de carga são esquecidas.
+*/
+struct Window
+{
+    Histogram histograms[2];
+    int current = 0;
+    uint64_t samples = 0;
+    uint64_t stale = REFRESH;
+    double quantile = 0;
+
+    /*  Uma amostra supera o quantil atual em no máximo LIMIT_GROWTH (e nunca
+        é limitada abaixo de LIMIT_FLOOR_MS): mesmo uma sequência de provas
+        lentas só faz o limite crescer aos poucos, a cada REFRESH amostras.
+    */
+    void record(double ms)
+    {
+        if (samples >= LIMIT_MIN_SAMPLES)
+        {
+            refresh();
+            const double bound = quantile * (1 + LIMIT_GROWTH);
+            const double cap = bound > LIMIT_FLOOR_MS ? bound : LIMIT_FLOOR_MS;
+            if (ms > cap)
+                ms = cap;
+        }
+
+        if (histograms[current].count() >= LIMIT_WINDOW)
+        {
+            current ^= 1;
+            histograms[current].reset();
+        }
+        histograms[current].recordMs(ms);
+        samples++;
+        stale++;
+    }
+
+    void reset()
+    {
+        histograms[0].reset();
+        histograms[1].reset();
+        current = 0;
+        samples = 0;
+        stale = REFRESH;
+    }
+
+    void refresh()
+    {
+        if (stale >= REFRESH)
+        {
+            const Histogram *both[2] = {&histograms[0], &histograms[1]};
+            quantile = Histogram::quantile(both, 2, LIMIT_QUANTILE);
+            stale = 0;
+        }
+    }
+
+    /* Quantil com folga, ou negativo se ainda não há amostras suficientes. */
+    double learned()
+    {
+        if (samples < LIMIT_MIN_SAMPLES)
+            return -1;
+
+        refresh();
+        return quantile * (1 + LIMIT_MARGIN);
+    }
+};
+
+struct Segment
+{
+    Window rsa; /* Excesso do tempo total sobre o esperado. */
+    Window dh;  /* Tempo total. */
+};
+
+static std::mutex lock;
+static std::unordered_map<uint32_t, Segment *> segments;
+static Segment shared;
+
+static uint32_t prefix(uint32_t peer)
+{
+    if (SEGMENT_PREFIX <= 0)
+        return 0;
+    return peer & (0xFFFFFFFFu << (32 - (SEGMENT_PREFIX > 32 ? 32 : SEGMENT_PREFIX)));
+}
+
+/* Chamado com o lock. */
+static Segment &segment(uint32_t peer)
+{
+    const uint32_t key = prefix(peer);
+
+    auto it = segments.find(key);
+    if (it != segments.end())
+        return *it->second;
+
+    if (segments.size() >= MAX_SEGMENTS)
+        return shared;
+
+    Segment *created = new Segment();
+    segments[key] = created;
+    return *created;
+}
+
+static double clamp(double limit)
+{
+    if (limit < LIMIT_FLOOR_MS)
+        return LIMIT_FLOOR_MS;
+    if (limit > LIMIT_CEILING_MS)
+        return LIMIT_CEILING_MS;
+    return limit;
+}
+
+double rsa(uint32_t peer, double expected)
+{
+    /*  Em uma rede local a troca leva dezenas de microssegundos, e 10% disso
+        fica abaixo da variação do próprio RSA do Cliente: a folga nunca é
+        menor que LIMIT_FLOOR_MS. Sem isso, só provas dentro da folga mínima
+        seriam aceitas e ensinariam o limite, que nunca cresceria.
+    */
+    const double original = expected * 0.1 > LIMIT_FLOOR_MS ? expected * 0.1 : LIMIT_FLOOR_MS;
+
+    std::lock_guard<std::mutex> guard(lock);
+    const double learned = segment(peer).rsa.learned();
+    if (learned < 0)
+        return expected + original;
+
+    return expected + (learned > original ? clamp(learned) : original);
+}
+
+void learnRSA(uint32_t peer, double expected, double totalTime)
+{
+    const double excess = totalTime - expected;
+
+    std::lock_guard<std::mutex> guard(lock);
+    segment(peer).rsa.record(excess > 0 ? excess : 0);
+}
+
+double dh(uint32_t peer)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    const double learned = segment(peer).dh.learned();
+    if (learned < 0)
+        return LIMIT_CEILING_MS;
+
+    return clamp(learned);
+}
+
+void learnDH(uint32_t peer, double totalTime)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    segment(peer).dh.record(totalTime);
+}
+
+void reset()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto &entry : segments)
+        delete entry.second;
+    segments.clear();
+
+    shared.rsa.reset();
+    shared.dh.reset();
+}
+
+}
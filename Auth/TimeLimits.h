@@ -0,0 +1,37 @@
+#ifndef TIME_LIMITS_H
+#define TIME_LIMITS_H
+
+#include <stdint.h>
+
+#include "../settings.h"
+
+/*  Limites das provas de tempo do Servidor.
+    Em vez de constantes, os limites vêm das latências observadas em cada
+    segmento de rede (prefixo SEGMENT_PREFIX do IPv4 do Cliente): o quantil
+    LIMIT_QUANTILE das duas últimas janelas, mais LIMIT_MARGIN, entre
+    LIMIT_FLOOR_MS e LIMIT_CEILING_MS. Até LIMIT_MIN_SAMPLES amostras, o
+    segmento usa os limites fixos originais. Só handshakes que passaram
+    nas verificações ensinam, e cada amostra é limitada a LIMIT_GROWTH
+    acima do quantil atual. Global ao processo.
+*/
+namespace limits
+{
+
+/*  Step 5: limite para o tempo total da troca RSA.
+    'expected' é processingTime1 + networkTime; o aprendido é o excesso
+    sobre ele, nunca menos que os 10% do limite original nem que
+    LIMIT_FLOOR_MS.
+*/
+double rsa(uint32_t peer, double expected);
+void learnRSA(uint32_t peer, double expected, double totalTime);
+
+/*  Step 7: limite para o tempo total da troca Diffie-Hellman. */
+double dh(uint32_t peer);
+void learnDH(uint32_t peer, double totalTime);
+
+/*  Descarta tudo o que foi aprendido. */
+void reset();
+
+}
+
+#endif
@@ -1,29 +1,41 @@
 #include "iotAuth.h"
 
-IotAuth::IotAuth()
+/*  Retorna um número aleatório menor que um dado limite superior.
+    Vem do gerador da thread (csprng), sem lock.
+*/
+int IotAuth::randomNumber(int upperBound)
 {
-    srand(time(NULL));
+    return csprng::uniform(upperBound);
 }
 
 
 
 
-/*  Retorna um número aleatório menor que um dado limite superior. */
-int IotAuth::randomNumber(int upperBound)
+/*  Gera um par de chaves RSA.
+    Assim como a cifragem RSA abaixo, roda no strand da sessão ou no pool de
+    workers quando houver um (offload), para não bloquear a thread de I/O.
+*/
+RSAKeyPair IotAuth::generateRSAKeyPair()
 {
-    return rand() % upperBound;
+    RSAKeyPair keys;
+    offload(strand, [&] { keys = makeRSAKeyPair(); });
+    return keys;
 }
 
 
 
 
-/*  Gera um par de chaves RSA. */
-RSAKeyPair IotAuth::generateRSAKeyPair()
+RSAKeyPair IotAuth::makeRSAKeyPair()
 {
     int p, p2, n, phi, e, d;
 
-    p = rsa.geraPrimo(100*rsa.geraNumeroRandom());
-    p2 = rsa.geraPrimo(100*rsa.geraNumeroRandom());
+    /*  Os primos devem ser distintos e o módulo maior que um byte,
+        já que a cifragem é feita byte a byte. */
+    do
+    {
+        p = rsa.geraPrimo(100*rsa.geraNumeroRandom());
+        p2 = rsa.geraPrimo(100*rsa.geraNumeroRandom());
+    } while (p == p2 || p * p2 <= 255);
 
     //Calcula o n
 	n = p * p2;
@@ -66,8 +78,8 @@ int* IotAuth::encryptRSA(string* plain, RSAKey* rsaKey, int size)
     char plainChar[plain->length()];
     strncpy(plainChar, plain->c_str(), sizeof(plainChar));
 
-    int* mensagemC = new int[size];
-    rsa.codifica(mensagemC, plainChar, rsaKey->d, rsaKey->n, sizeof(plainChar));
+    int* mensagemC = arena.array<int>(size);
+    offload(strand, [&] { rsa.codifica(mensagemC, plainChar, rsaKey->d, rsaKey->n, sizeof(plainChar)); });
 
     return mensagemC;
 }
@@ -79,8 +91,8 @@ int* IotAuth::encryptRSA(string* plain, RSAKey* rsaKey, int size)
 */
 int* IotAuth::encryptRSA(byte plain[], RSAKey* rsaKey, int size)
 {
-    int* mensagemC = new int[size];
-    rsa.codifica(mensagemC, plain, rsaKey->d, rsaKey->n, size);
+    int* mensagemC = arena.array<int>(size);
+    offload(strand, [&] { rsa.codifica(mensagemC, plain, rsaKey->d, rsaKey->n, size); });
 
     return mensagemC;
 }
@@ -91,9 +103,9 @@ int* IotAuth::encryptRSA(byte plain[], RSAKey* rsaKey, int size)
 /*  Decifra utilizando o algoritmo RSA. */
 byte* IotAuth::decryptRSA(int *cipher, RSAKey *rsaKey, int size)
 {
-    byte* plain = new byte[size];
-    memset(plain, 0, sizeof(plain));
-    rsa.decodifica(plain, cipher, rsaKey->d, rsaKey->n, size);
+    byte* plain = arena.array<byte>(size);
+    memset(plain, 0, size);
+    offload(strand, [&] { rsa.decodifica(plain, cipher, rsaKey->d, rsaKey->n, size); });
     
     return plain;
 }
@@ -101,36 +113,6 @@ byte* IotAuth::decryptRSA(int *cipher, RSAKey *rsaKey, int size)
 
 
 
-/*  Cifra com o algoritmo AES. */
-uint8_t* IotAuth::encryptAES(uint8_t* plaintext, uint8_t* key, uint8_t* iv, int size)
-{
-    uint8_t *ciphertext = plaintext;
-
-    struct AES_ctx ctx;
-    aes.AES_init_ctx_iv(&ctx, key, iv);
-    aes.AES_CBC_encrypt_buffer(&ctx, ciphertext, size);
-
-    return ciphertext;
-}
-
-
-
-
-/*  Decifra com o algoritmo AES. */
-uint8_t* IotAuth::decryptAES(uint8_t ciphertext[], uint8_t key[], uint8_t iv[], int size)
-{
-    uint8_t *plaintext = ciphertext;
-
-    struct AES_ctx ctx;
-    aes.AES_init_ctx_iv(&ctx, key, iv);
-    aes.AES_CBC_decrypt_buffer(&ctx, plaintext, size);
-
-    return plaintext;
-}
-
-
-
-
 /*  Verifica se a resposta do FDR está correta. */
 bool IotAuth::isAnswerCorrect(FDR* fdr, int argument, int answerFdr)
 {
@@ -140,28 +122,6 @@ bool IotAuth::isAnswerCorrect(FDR* fdr, int argument, int answerFdr)
 
 
 
-/* Verifica se o HASH dado é idêntico ao HASH da mensagem. */
-bool IotAuth::isHashValid(string *message, string *hash) {
-    string hash2 = this->hash(message);
-    return *hash == hash2;
-}
-
-
-
-
-/*  Recebe uma mensagem e uma chave por parâmetro, e retorna o hash
-    desta mensagem assinado com a chave.
-*/
-int *IotAuth::signedHash(string *message, RSAKey *key)
-{
-    string h = hash(message);
-    cout << "HASH: " << h << endl;
-    return encryptRSA(&h, key, h.length());
-}
-
-
-
-
 /*  Retorna o hash de uma dada mensagem. */
 string IotAuth::hash(string *message)
 {
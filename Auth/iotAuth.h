@@ -3,10 +3,13 @@
 
 #include "../settings.h"
 #include "../utils.h"
+#include "../random.h"
 #include "../fdr.h"
 #include "../RSA/RSA.h"
 #include "../AES/AES.h"
 #include "../SHA/sha512.h"
+#include "../Event/SessionScheduler.h"
+#include "Arena.h"
 
 using namespace std;
 
@@ -16,7 +19,15 @@ class IotAuth
 
     public:
 
-        IotAuth();
+        /*  Memória da sessão. Os vetores devolvidos pelas funções RSA vêm
+            daqui e valem até arena.reset(); não devem ser liberados.
+        */
+        Arena arena;
+
+        /*  Sessão dona do RSA, que roda no strand dela no SessionScheduler
+            quando houver um; 0 usa o pool de workers comum (offload).
+        */
+        uint32_t strand = 0;
 
         /*  Retorna um número aleatório menor que um dado limite superior. */
         int randomNumber(int upperBound);
@@ -50,13 +61,31 @@ class IotAuth
 
 
 
-        /*  Cifra com o algoritmo AES. */
-        uint8_t* encryptAES(uint8_t* plaintext, uint8_t* key, uint8_t* iv, int size);
+        /*  Cifra com o algoritmo AES (CBC) no próprio buffer. A chave tem
+            AES<KeyBits>::KEYLEN bytes.
+        */
+        template <int KeyBits>
+        uint8_t* encryptAES(uint8_t* plaintext, uint8_t* key, uint8_t* iv, int size)
+        {
+            AES<KeyBits> aes;
+            typename AES<KeyBits>::AES_ctx ctx;
+            aes.AES_init_ctx_iv(&ctx, key, iv);
+            aes.AES_CBC_encrypt_buffer(&ctx, plaintext, size);
+            return plaintext;
+        }
 
 
 
-        /*  Decifra com o algoritmo AES. */
-        uint8_t* decryptAES(uint8_t* ciphertext, uint8_t* key, uint8_t* iv, int size);
+        /*  Decifra com o algoritmo AES (CBC) no próprio buffer. */
+        template <int KeyBits>
+        uint8_t* decryptAES(uint8_t* ciphertext, uint8_t* key, uint8_t* iv, int size)
+        {
+            AES<KeyBits> aes;
+            typename AES<KeyBits>::AES_ctx ctx;
+            aes.AES_init_ctx_iv(&ctx, key, iv);
+            aes.AES_CBC_decrypt_buffer(&ctx, ciphertext, size);
+            return ciphertext;
+        }
 
 
 
@@ -65,15 +94,38 @@ class IotAuth
 
 
 
-        /*  Verifica se o Hash é compatível com a mensagem. */
-        bool isHashValid(string *message, string *hash);
+        /*  Tamanho do hash assinado nos pacotes: SHA-512 em hexadecimal. */
+        static const int HASH_SIZE = 2 * SHA512::DIGEST_SIZE;
 
 
 
-        /*  Recebe uma mensagem e uma chave por parâmetro, e retorna o hash
-            desta mensagem assinado com a chave.
+        /*  Verifica se o hash decifrado (HASH_SIZE bytes) é o hash canônico
+            do pacote (RSAPackage ou DiffieHellmanPackage).
         */
-        int *signedHash(string *message, RSAKey *key);
+        template <typename Package>
+        bool isHashValid(Package *package, const byte *hash)
+        {
+            char expected[HASH_SIZE];
+            packageHash(package, expected);
+            return constantTimeEquals(expected, hash, HASH_SIZE);
+        }
+
+
+
+        /*  Recebe um pacote e uma chave por parâmetro, e retorna o hash
+            canônico do pacote assinado com a chave. Nada é alocado ou
+            formatado além do resultado, que vem da arena. Com 'verbose'
+            (a política de quem chama), o hash é impresso.
+        */
+        template <typename Package>
+        int *signedHash(Package *package, RSAKey *key, bool verbose = VERBOSE)
+        {
+            char hash[HASH_SIZE];
+            packageHash(package, hash);
+            if (verbose)
+                cout << "HASH: " << string(hash, HASH_SIZE) << endl;
+            return encryptRSA((byte *)hash, key, HASH_SIZE);
+        }
 
 
 
@@ -82,7 +134,22 @@ class IotAuth
 
     private:
 
-        AES aes;    /*  Instância da classe AES.    */
         RSA rsa;    /*  Instância da classe RSA.    */
+
+        /*  Geração do par de chaves, executada por generateRSAKeyPair(). */
+        RSAKeyPair makeRSAKeyPair();
+
+        /*  SHA-512 da codificação canônica do pacote, em hexadecimal e sem
+            terminador, calculado direto dos campos.
+        */
+        template <typename Package>
+        static void packageHash(Package *package, char *hex)
+        {
+            SHA512 sha;
+            sha.init();
+            package->hash(&sha);
+            sha.final((uint8_t *)hex);
+            BytesToHexStringInPlace((uint8_t *)hex, SHA512::DIGEST_SIZE);
+        }
 };
 #endif
@@ -0,0 +1,285 @@
+/*  Crypto Benchmark
+    Mede isoladamente cada primitiva de AES/, SHA/, RSA/ e Diffie-Hellman/,
+    para vários tamanhos de entrada, reportando ciclos por byte e operações
+    por segundo.
+
+    Uso: ./crypto [-m ms por medida] [-f filtro] [-o saida.json]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "cycles.h"
+#include "../time.h"
+#include "../random.h"
+#include "../settings.h"
+#include "../AES/AES.h"
+#include "../SHA/sha512.h"
+#include "../RSA/RSA.h"
+#include "../Auth/iotAuth.h"
+#include "../Diffie-Hellman/DHStorage.h"
+
+typedef struct row
+{
+    std::string group;
+    std::string primitive;
+    size_t bytes;           /* 0 para operações sem tamanho de entrada. */
+    unsigned long iterations;
+    double nsPerOp;
+    double cyclesPerOp;
+} Row;
+
+static std::vector<Row> rows;
+static double minTime = 200;      /* Tempo mínimo de cada medida, em ms. */
+static const char *filter = NULL;
+
+/* Impede que o compilador descarte o resultado das operações medidas. */
+static volatile long sink;
+
+/*  Executa 'op' repetidamente, dobrando o número de iterações até que a
+    medida dure ao menos minTime, e registra o custo médio por operação.
+*/
+template <typename Op>
+static void bench(const char *group, const char *primitive, size_t bytes, Op op)
+{
+    const std::string name = std::string(group) + "/" + primitive;
+    if (filter != NULL && name.find(filter) == std::string::npos)
+        return;
+
+    for (int i = 0; i < 3; i++)
+        op();
+
+    unsigned long iterations = 1;
+    double elapsed;
+    uint64_t spent;
+
+    while (true)
+    {
+        const double start = currentTime();
+        const uint64_t startCycles = cycles();
+
+        for (unsigned long i = 0; i < iterations; i++)
+            op();
+
+        spent = cycles() - startCycles;
+        elapsed = elapsedTime(start, currentTime());
+
+        if (elapsed >= minTime)
+            break;
+        iterations *= 2;
+    }
+
+    Row row;
+    row.group = group;
+    row.primitive = primitive;
+    row.bytes = bytes;
+    row.iterations = iterations;
+    row.nsPerOp = elapsed * 1000000.0 / iterations;
+    row.cyclesPerOp = (double)spent / iterations;
+    rows.push_back(row);
+
+    printf("%-6s %-28s %7zu %12.1f %14.1f", group, primitive, bytes, row.nsPerOp, 1e9 / row.nsPerOp);
+    if (HAS_CYCLE_COUNTER)
+    {
+        printf(" %14.1f", row.cyclesPerOp);
+        if (bytes)
+            printf(" %12.2f", row.cyclesPerOp / bytes);
+    }
+    printf("\n");
+}
+
+static void fill(std::vector<uint8_t> &buffer)
+{
+    csprng::fill(buffer.data(), buffer.size());
+}
+
+/*  Operandos sorteados antes da medida, em [0, bound): as operações os
+    percorrem em ciclo, sem o custo do gerador dentro do tempo medido.
+*/
+#define OPERANDS 1024
+
+static std::vector<int> operands(uint32_t bound)
+{
+    std::vector<int> values(OPERANDS);
+    for (int &value : values)
+        value = csprng::uniform(bound);
+    return values;
+}
+
+/* Mede um tamanho de chave do AES; 'group' nomeia o tamanho no relatório. */
+template <int KeyBits>
+static void benchAES(const char *group, const std::vector<size_t> &sizes)
+{
+    AES<KeyBits> aes;
+    typename AES<KeyBits>::AES_ctx ctx;
+    uint8_t key[AES<KeyBits>::KEYLEN], iv[AES_BLOCKLEN];
+
+    csprng::fill(key, sizeof(key));
+    csprng::fill(iv, sizeof(iv));
+
+    bench(group, "init_ctx_iv", 0, [&] { aes.AES_init_ctx_iv(&ctx, key, iv); });
+
+    aes.AES_init_ctx_iv(&ctx, key, iv);
+    uint8_t block[AES_BLOCKLEN] = {0};
+    bench(group, "ECB_encrypt", AES_BLOCKLEN, [&] { aes.AES_ECB_encrypt(&ctx, block); });
+    bench(group, "ECB_decrypt", AES_BLOCKLEN, [&] { aes.AES_ECB_decrypt(&ctx, block); });
+
+    for (size_t size : sizes)
+    {
+        std::vector<uint8_t> buffer(size);
+        fill(buffer);
+
+        bench(group, "CBC_encrypt_buffer", size, [&] { aes.AES_CBC_encrypt_buffer(&ctx, buffer.data(), size); });
+        bench(group, "CBC_decrypt_buffer", size, [&] { aes.AES_CBC_decrypt_buffer(&ctx, buffer.data(), size); });
+        bench(group, "CTR_xcrypt_buffer", size, [&] { aes.AES_CTR_xcrypt_buffer(&ctx, buffer.data(), size); });
+    }
+}
+
+static void benchSHA(const std::vector<size_t> &sizes)
+{
+    unsigned char digest[SHA512::DIGEST_SIZE];
+
+    for (size_t size : sizes)
+    {
+        std::vector<uint8_t> buffer(size);
+        fill(buffer);
+        const std::string input(buffer.begin(), buffer.end());
+
+        bench("SHA", "init_update_final", size, [&] {
+            SHA512 ctx;
+            ctx.init();
+            ctx.update(buffer.data(), size);
+            ctx.final(digest);
+            sink = digest[0];
+        });
+
+        bench("SHA", "sha512_hex", size, [&] { sink = sha512(input).length(); });
+    }
+}
+
+static void benchRSA(const std::vector<size_t> &sizes)
+{
+    RSA rsa;
+    IotAuth iotAuth;
+
+    bench("RSA", "generateRSAKeyPair", 0, [&] { sink = iotAuth.generateRSAKeyPair().publicKey.n; });
+    bench("RSA", "geraPrimo", 0, [&] { sink = rsa.geraPrimo(100 * (rsa.geraNumeroRandom() + 1)); });
+
+    const RSAKeyPair keys = iotAuth.generateRSAKeyPair();
+    const long long phi = 1000 * 1000;
+
+    bench("RSA", "verificaPrimo", 0, [&] { sink = rsa.verificaPrimo(9973); });
+    bench("RSA", "mdcEstendido", 0, [&] { sink = rsa.mdcEstendido(phi, 7); });
+    const std::vector<int> bytes = operands(256);
+    size_t next = 0;
+    bench("RSA", "potencia", 0, [&] { sink = rsa.potencia(bytes[next++ % OPERANDS], keys.publicKey.d, keys.publicKey.n); });
+    bench("RSA", "expModular", 0, [&] { sink = rsa.expModular(bytes[next++ % OPERANDS], 17, 3233); });
+
+    for (size_t size : sizes)
+    {
+        std::vector<uint8_t> plain(size);
+        std::vector<int> cipher(size);
+        fill(plain);
+
+        bench("RSA", "codifica", size, [&] {
+            rsa.codifica(cipher.data(), plain.data(), keys.privateKey.d, keys.privateKey.n, size);
+        });
+        bench("RSA", "decodifica", size, [&] {
+            rsa.decodifica(plain.data(), cipher.data(), keys.publicKey.d, keys.publicKey.n, size);
+        });
+
+        RSAKey privateKey = keys.privateKey, publicKey = keys.publicKey;
+        bench("RSA", "IotAuth::encryptRSA", size, [&] {
+            int *encrypted = iotAuth.encryptRSA(plain.data(), &privateKey, size);
+            sink = encrypted[0];
+            iotAuth.arena.reset();
+        });
+        bench("RSA", "IotAuth::decryptRSA", size, [&] {
+            byte *decrypted = iotAuth.decryptRSA(cipher.data(), &publicKey, size);
+            sink = decrypted[0];
+            iotAuth.arena.reset();
+        });
+    }
+}
+
+static void benchDH()
+{
+    IotAuth iotAuth;
+    DHStorage storage;
+    storage.setBase(iotAuth.randomNumber(100) + 2);
+    storage.setExponent(iotAuth.randomNumber(3) + 2);
+    storage.setModulus(iotAuth.randomNumber(100) + 2);
+
+    bench("DH", "calculateResult", 0, [&] { sink = storage.calculateResult(); });
+    const std::vector<int> results = operands(100);
+    size_t next = 0;
+    bench("DH", "calculateSessionKey", 0, [&] { sink = storage.calculateSessionKey(results[next++ % OPERANDS]); });
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output = "crypto.json";
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+
+        if (!strcmp(argv[i], "-m") && hasValue)
+            minTime = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && hasValue)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "-o") && hasValue)
+            output = argv[++i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [-m ms] [-f filter] [-o output.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const std::vector<size_t> sizes = {16, 64, 256, 1024, 4096, 16384};
+
+    printf("clock=%s\n\n", clockSource());
+    printf("%-6s %-28s %7s %12s %14s", "group", "primitive", "bytes", "ns/op", "ops/s");
+    if (HAS_CYCLE_COUNTER)
+        printf(" %14s %12s", "cycles/op", "cycles/byte");
+    printf("\n");
+
+    benchAES<128>("AES128", sizes);
+    benchAES<192>("AES192", sizes);
+    benchAES<256>("AES256", sizes);
+    benchSHA(sizes);
+    benchRSA(sizes);
+    benchDH();
+
+    FILE *out = fopen(output, "w");
+    if (out == NULL)
+    {
+        perror(output);
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"benchmark\": \"crypto\",\n  \"results\": [\n");
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        Row &r = rows[i];
+        fprintf(out, "    {\"group\": \"%s\", \"primitive\": \"%s\", \"bytes\": %zu, \"iterations\": %lu, "
+                     "\"ns_per_op\": %.3f, \"ops_per_second\": %.3f",
+                r.group.c_str(), r.primitive.c_str(), r.bytes, r.iterations, r.nsPerOp, 1e9 / r.nsPerOp);
+        if (HAS_CYCLE_COUNTER)
+        {
+            fprintf(out, ", \"cycles_per_op\": %.3f", r.cyclesPerOp);
+            if (r.bytes)
+                fprintf(out, ", \"cycles_per_byte\": %.3f", r.cyclesPerOp / r.bytes);
+        }
+        fprintf(out, "}%s\n", i + 1 < rows.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    fclose(out);
+
+    printf("\nwritten to %s\n", output);
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER 1
+#else
+#define HAS_CYCLE_COUNTER 0
+#endif
+
+/*  Lê o contador de ciclos da CPU (TSC em x86).
+    Em arquiteturas sem contador disponível retorna 0.
+*/
+static inline uint64_t cycles()
+{
+#if HAS_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+#endif
@@ -0,0 +1,253 @@
+/*  Handshake Benchmark
+    Executa N handshakes completos (connect()) sobre enlaces loopback em
+    memória, em uma ou mais threads, e reporta handshakes por segundo e a
+    latência de cada etapa (p50/p90/p99/p999).
+
+    Uso: ./handshake [-n handshakes] [-t threads] [-w aquecimento] [-o saida.json]
+                     [--trace arquivo] [--resume] [--crypto-workers n]
+
+    Cada thread é um par Cliente/Servidor com seu próprio enlace. As etapas
+    seguem os passos do AuthClient:
+        SYN/ACK  Steps 1-2      RSA     Steps 3-4      RSA-ACK  Step 5
+        DH       Steps 6-7      DH-ACK  Step 8
+
+    Com --resume, cada Cliente retoma a sessão anterior com o ticket recebido
+    e toda a retomada aparece na etapa SYN/ACK.
+
+    As latências consideram só os handshakes concluídos; as falhas são
+    contadas por status, junto com o tempo gasto nelas, à parte.
+
+    Com --crypto-workers, o RSA dos Servidores roda em n threads
+    compartilhadas (Event/SessionScheduler), um strand por handshake; sem
+    ele, na thread de cada Servidor. O script de compilação desliga o
+    início automático (-DCRYPTO_WORKERS=0) para que as duas formas possam
+    ser comparadas.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "harness.h"
+#include "../Auth/AuthClient.h"
+#include "../Event/SessionScheduler.h"
+#include "../Socket/LoopbackTransport.h"
+
+#define STAGES 6
+#define STATUSES (NOT_CONNECTED + 1)
+
+/* Nome de cada etapa e os passos (índices de stepTimes) que a delimitam. */
+static const char *stageName[STAGES] = {"syn_ack", "rsa", "rsa_ack", "dh", "dh_ack", "total"};
+static const int stageBegin[STAGES] = {0, 2, 4, 5, 7, 0};
+static const int stageEnd[STAGES] = {2, 4, 5, 7, 8, 8};
+
+static const char *statusName[STATUSES] = {"OK", "DENIED", "TIMEOUT", "NO_REPLY", "NONCE_INVALID",
+                                           "FDR_INVALID", "HASH_INVALID", "FINISHED", "NOT_CONNECTED"};
+
+typedef struct samples
+{
+    std::vector<double> stage[STAGES]; /* Em ms. */
+    int attempts = 0;
+    int failures[STATUSES] = {0};
+    double failedTime = 0;  /* Em ms, gastos nas tentativas que falharam. */
+} Samples;
+
+static void worker(int handshakes, int warmup, bool resume, Samples *samples)
+{
+    LoopbackLink link;
+    BenchServer server(link.server());
+    BasicAuthClient<QuietPolicy> client(link.client());
+
+    char address[] = "127.0.0.1";
+
+    for (int i = 0; i < warmup + handshakes; i++)
+    {
+        if (!resume)
+            client.forgetSession();
+
+        const double begin = currentTime();
+        const int result = client.connect(address);
+
+        if (!client.isConnected())
+        {
+            /* Só o connect() conta: o descarte abaixo espera o timeout do enlace. */
+            if (i >= warmup)
+            {
+                samples->attempts++;
+                samples->failures[result >= 0 && result < STATUSES ? result : DENIED]++;
+                samples->failedTime += elapsedTime(begin, currentTime());
+            }
+            abortSession(link.client());
+            continue;
+        }
+
+        if (i >= warmup)
+        {
+            samples->attempts++;
+
+            const double *steps = client.stepTimes();
+            for (int s = 0; s < STAGES; s++)
+                samples->stage[s].push_back(elapsedTime(steps[stageBegin[s]], steps[stageEnd[s]]));
+        }
+
+        client.disconnect();
+    }
+
+    server.stop(link.client());
+}
+
+static void writeStage(FILE *out, const char *name, std::vector<double> &values, bool last)
+{
+    double mean = 0;
+    for (double v : values)
+        mean += v;
+    if (!values.empty())
+        mean /= values.size();
+
+    fprintf(out, "    \"%s\": {\"mean\": %.6f, \"p50\": %.6f, \"p90\": %.6f, \"p99\": %.6f, \"p999\": %.6f, \"max\": %.6f}%s\n",
+            name, mean,
+            percentile(values, 0.5), percentile(values, 0.9),
+            percentile(values, 0.99), percentile(values, 0.999),
+            values.empty() ? 0 : values.back(),
+            last ? "" : ",");
+}
+
+int main(int argc, char *argv[])
+{
+    int handshakes = 1000;
+    int threads = 1;
+    int warmup = 10;
+    const char *output = "handshake.json";
+    const char *tracePath = NULL;
+    bool resume = false;
+    int cryptoWorkers = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+
+        if (!strcmp(argv[i], "-n") && hasValue)
+            handshakes = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && hasValue)
+            threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-w") && hasValue)
+            warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && hasValue)
+            output = argv[++i];
+        else if (!strcmp(argv[i], "--trace") && hasValue)
+            tracePath = argv[++i];
+        else if (!strcmp(argv[i], "--resume"))
+            resume = true;
+        else if (!strcmp(argv[i], "--crypto-workers") && hasValue)
+            cryptoWorkers = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n handshakes] [-t threads] [-w warmup] [-o output.json] [--trace file] [--resume] [--crypto-workers n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (threads < 1)
+        threads = 1;
+
+    if (tracePath != NULL && !trace::start(tracePath))
+        return 1;
+
+    if (cryptoWorkers > 0)
+        SessionScheduler::start(cryptoWorkers);
+
+    std::vector<Samples> samples(threads);
+    std::vector<std::thread> workers;
+
+    const double start = currentTime();
+    for (int t = 0; t < threads; t++)
+    {
+        const int share = handshakes / threads + (t < handshakes % threads ? 1 : 0);
+        workers.push_back(std::thread(worker, share, warmup, resume, &samples[t]));
+    }
+    for (std::thread &w : workers)
+        w.join();
+    const double seconds = elapsedTime(start, currentTime()) / 1000.0;
+
+    SessionScheduler::stop();
+    trace::stop();
+
+    /******************** Merge ********************/
+    Samples all;
+    for (Samples &s : samples)
+    {
+        all.attempts += s.attempts;
+        all.failedTime += s.failedTime;
+        for (int f = 0; f < STATUSES; f++)
+            all.failures[f] += s.failures[f];
+        for (int st = 0; st < STAGES; st++)
+            all.stage[st].insert(all.stage[st].end(), s.stage[st].begin(), s.stage[st].end());
+    }
+    for (int st = 0; st < STAGES; st++)
+        std::sort(all.stage[st].begin(), all.stage[st].end());
+
+    const int completed = all.stage[STAGES - 1].size();
+    const double rate = seconds > 0 ? completed / seconds : 0;
+
+    /******************** Report ********************/
+    printf("clock=%s threads=%d crypto-workers=%d attempts=%d completed=%d failed=%d time=%.3fs\n",
+           clockSource(), threads, cryptoWorkers, all.attempts, completed, all.attempts - completed, seconds);
+    printf("throughput: %.1f handshakes/s\n", rate);
+    if (all.attempts > completed)
+        printf("failures: %d (%.1f%%), %.3fs spent in failed attempts\n", all.attempts - completed,
+               100.0 * (all.attempts - completed) / all.attempts, all.failedTime / 1000.0);
+    for (int f = 0; f < STATUSES; f++)
+        if (all.failures[f])
+            printf("failed with %s: %d\n", statusName[f], all.failures[f]);
+    printf("\n");
+    printf("%-8s %10s %10s %10s %10s %10s\n", "stage", "p50(ms)", "p90(ms)", "p99(ms)", "p999(ms)", "max(ms)");
+    for (int st = 0; st < STAGES; st++)
+    {
+        std::vector<double> &v = all.stage[st];
+        printf("%-8s %10.4f %10.4f %10.4f %10.4f %10.4f\n", stageName[st],
+               percentile(v, 0.5), percentile(v, 0.9), percentile(v, 0.99), percentile(v, 0.999),
+               v.empty() ? 0 : v.back());
+    }
+
+    FILE *out = fopen(output, "w");
+    if (out == NULL)
+    {
+        perror(output);
+        return 1;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"benchmark\": \"handshake\",\n");
+    fprintf(out, "  \"transport\": \"loopback\",\n");
+    fprintf(out, "  \"clock\": \"%s\",\n", clockSource());
+    fprintf(out, "  \"threads\": %d,\n", threads);
+    fprintf(out, "  \"crypto_workers\": %d,\n", cryptoWorkers);
+    fprintf(out, "  \"attempts\": %d,\n", all.attempts);
+    fprintf(out, "  \"completed\": %d,\n", completed);
+    fprintf(out, "  \"seconds\": %.6f,\n", seconds);
+    fprintf(out, "  \"handshakes_per_second\": %.3f,\n", rate);
+    fprintf(out, "  \"failed\": %d,\n", all.attempts - completed);
+    fprintf(out, "  \"failed_seconds\": %.6f,\n", all.failedTime / 1000.0);
+    fprintf(out, "  \"failures\": {");
+    for (int f = 0, first = 1; f < STATUSES; f++)
+    {
+        if (!all.failures[f])
+            continue;
+        fprintf(out, "%s\"%s\": %d", first ? "" : ", ", statusName[f], all.failures[f]);
+        first = 0;
+    }
+    fprintf(out, "},\n");
+    fprintf(out, "  \"latency_ms\": {\n");
+    for (int st = 0; st < STAGES; st++)
+        writeStage(out, stageName[st], all.stage[st], st == STAGES - 1);
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+    fclose(out);
+
+    printf("\nwritten to %s\n", output);
+    return 0;
+}
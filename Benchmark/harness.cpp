@@ -0,0 +1,86 @@
+#include "harness.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <cmath>
+
+#include "../Auth/AuthServer.h"
+
+BenchServer::BenchServer(Transport *transport)
+    : transport(transport), finished(false), stopped(false)
+{
+    thread = std::thread(&BenchServer::serve, this);
+}
+
+BenchServer::~BenchServer()
+{
+    if (thread.joinable())
+        thread.join();
+}
+
+/*  Encerra o Servidor, enviando pedidos de desconexão pelo transporte
+    do Cliente até que a thread termine.
+*/
+void BenchServer::stop(Transport *peer)
+{
+    finished = true;
+
+    /* O pedido pode se perder em um transporte com perdas: repete até o Servidor sair. */
+    while (!stopped)
+    {
+        peer->send(DONE_MESSAGE, sizeof(DONE_MESSAGE));
+        usleep(10000);
+    }
+    thread.join();
+}
+
+void BenchServer::serve()
+{
+    BasicAuthServer<QuietPolicy> server(transport);
+
+    while (!finished)
+    {
+        server.wait_connection();
+
+        while (server.isConnected() && !finished)
+        {
+            try
+            {
+                server.listen();
+            }
+            catch (status e)
+            {
+                server.disconnect();
+            }
+        }
+    }
+
+    stopped = true;
+}
+
+/*  Abandona um handshake que falhou no meio do caminho: envia um pedido
+    de desconexão e descarta o que ainda estiver em trânsito, para que a
+    próxima tentativa comece com o Servidor aguardando um SYN.
+*/
+void abortSession(Transport *transport)
+{
+    char discard[4096];
+
+    transport->send(DONE_MESSAGE, sizeof(DONE_MESSAGE));
+    while (transport->recv(discard, sizeof(discard)) > 0);
+}
+
+/*  Retorna o valor no quantil dado (0..1) de um vetor já ordenado. */
+double percentile(const std::vector<double> &sorted, double quantile)
+{
+    if (sorted.empty())
+        return 0;
+
+    size_t rank = (size_t)std::ceil(quantile * sorted.size());
+    if (rank > 0)
+        rank--;
+    if (rank >= sorted.size())
+        rank = sorted.size() - 1;
+
+    return sorted[rank];
+}
@@ -0,0 +1,44 @@
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../settings.h"
+#include "../Socket/Transport.h"
+
+/*  Servidor utilizado pelos benchmarks.
+    Roda um AuthServer em uma thread própria, aceitando conexões e
+    consumindo as publicações até que stop() seja chamado.
+*/
+class BenchServer
+{
+  public:
+    BenchServer(Transport *transport);
+    ~BenchServer();
+
+    /*  Encerra o Servidor, enviando pedidos de desconexão pelo transporte
+        do Cliente até que a thread termine.
+    */
+    void stop(Transport *peer);
+
+  private:
+    Transport *transport;
+    std::atomic<bool> finished;
+    std::atomic<bool> stopped;
+    std::thread thread;
+
+    void serve();
+};
+
+/*  Abandona um handshake que falhou no meio do caminho: envia um pedido
+    de desconexão e descarta o que ainda estiver em trânsito, para que a
+    próxima tentativa comece com o Servidor aguardando um SYN.
+*/
+void abortSession(Transport *transport);
+
+/*  Retorna o valor no quantil dado (0..1) de um vetor já ordenado. */
+double percentile(const std::vector<double> &sorted, double quantile);
+
+#endif
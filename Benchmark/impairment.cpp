@@ -0,0 +1,197 @@
+/*  Impairment Benchmark
+    Mede o tempo de handshake e o goodput das publicações sobre um enlace
+    simulado com atraso, jitter, perda, duplicação e reordenação.
+
+    Uso: ./impairment [-n handshakes] [-p publicações] [-s seed]
+                      [--delay ms] [--jitter ms] [--loss p] [--duplicate p] [--reorder p]
+
+    Sem opções de impairment, percorre um conjunto de perfis pré-definidos.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "../Auth/AuthClient.h"
+#include "../Socket/LoopbackTransport.h"
+#include "../Socket/ImpairedTransport.h"
+
+typedef struct profile
+{
+    std::string name;
+    Impairment impairment;
+} Profile;
+
+typedef struct result
+{
+    int attempts = 0;
+    std::vector<double> handshakes;   /* Tempo de cada handshake concluído, em ms. */
+    int published = 0;
+    int acknowledged = 0;
+    double publishTime = 0;           /* Tempo total gasto publicando, em ms. */
+    unsigned long dropped = 0, duplicated = 0, reordered = 0;
+} Result;
+
+static Profile makeProfile(std::string name, double delay, double jitter, double loss, double duplicate, double reorder)
+{
+    Profile profile;
+    profile.name = name;
+    profile.impairment.delay = delay;
+    profile.impairment.jitter = jitter;
+    profile.impairment.loss = loss;
+    profile.impairment.duplicate = duplicate;
+    profile.impairment.reorder = reorder;
+    return profile;
+}
+
+static Result run(Profile &profile, int handshakes, int publishes, unsigned seed)
+{
+    Result result;
+
+    LoopbackLink link;
+
+    Impairment serverImpairment = profile.impairment;
+    serverImpairment.seed = seed;
+    Impairment clientImpairment = profile.impairment;
+    clientImpairment.seed = seed + 1;
+
+    ImpairedTransport serverSide(link.server(), serverImpairment);
+    ImpairedTransport clientSide(link.client(), clientImpairment);
+
+    BenchServer server(&serverSide);
+    BasicAuthClient<QuietPolicy> client(&clientSide);
+
+    char address[] = "127.0.0.1";
+    char data[666];
+    memset(data, 'x', sizeof(data));
+
+    for (int i = 0; i < handshakes; i++)
+    {
+        result.attempts++;
+
+        double start = currentTime();
+        client.connect(address);
+        double end = currentTime();
+
+        if (!client.isConnected())
+        {
+            abortSession(&clientSide);
+            continue;
+        }
+
+        result.handshakes.push_back(elapsedTime(start, end));
+
+        start = currentTime();
+        for (int p = 0; p < publishes; p++)
+        {
+            result.published++;
+            if (client.publish(data) == OK)
+                result.acknowledged++;
+        }
+        end = currentTime();
+        result.publishTime += elapsedTime(start, end);
+
+        client.disconnect();
+    }
+
+    server.stop(link.client());
+
+    result.dropped = serverSide.dropped() + clientSide.dropped();
+    result.duplicated = serverSide.duplicated() + clientSide.duplicated();
+    result.reordered = serverSide.reordered() + clientSide.reordered();
+
+    return result;
+}
+
+static void report(Profile &profile, Result &result)
+{
+    std::vector<double> &times = result.handshakes;
+    std::sort(times.begin(), times.end());
+
+    double mean = 0;
+    for (double t : times)
+        mean += t;
+    if (!times.empty())
+        mean /= times.size();
+
+    const double completion = result.attempts ? 100.0 * times.size() / result.attempts : 0;
+    const double goodput = result.publishTime > 0 ? result.acknowledged / (result.publishTime / 1000.0) : 0;
+
+    printf("%-10s %6.1f %6.1f %5.1f%% %5.1f%% %5.1f%% | %6.1f%% %9.2f %9.2f %9.2f | %4d/%-4d %9.1f %11.0f | %lu/%lu/%lu\n",
+           profile.name.c_str(),
+           profile.impairment.delay, profile.impairment.jitter,
+           profile.impairment.loss * 100, profile.impairment.duplicate * 100, profile.impairment.reorder * 100,
+           completion, mean, percentile(times, 0.5), percentile(times, 0.99),
+           result.acknowledged, result.published, goodput, goodput * 666,
+           result.dropped, result.duplicated, result.reordered);
+}
+
+int main(int argc, char *argv[])
+{
+    int handshakes = 20;
+    int publishes = 10;
+    unsigned seed = 1;
+
+    bool custom = false;
+    Profile customProfile = makeProfile("custom", 0, 0, 0, 0, 0);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+
+        if (!strcmp(argv[i], "-n") && hasValue)
+            handshakes = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-p") && hasValue)
+            publishes = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && hasValue)
+            seed = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--delay") && hasValue)
+            custom = true, customProfile.impairment.delay = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--jitter") && hasValue)
+            custom = true, customProfile.impairment.jitter = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--loss") && hasValue)
+            custom = true, customProfile.impairment.loss = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--duplicate") && hasValue)
+            custom = true, customProfile.impairment.duplicate = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--reorder") && hasValue)
+            custom = true, customProfile.impairment.reorder = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n handshakes] [-p publishes] [-s seed] "
+                            "[--delay ms] [--jitter ms] [--loss p] [--duplicate p] [--reorder p]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Profile> profiles;
+    if (custom)
+    {
+        profiles.push_back(customProfile);
+    }
+    else
+    {
+        profiles.push_back(makeProfile("ideal", 0, 0, 0, 0, 0));
+        profiles.push_back(makeProfile("wifi", 2, 1, 0.005, 0, 0));
+        profiles.push_back(makeProfile("wifi-bad", 5, 5, 0.02, 0.005, 0.01));
+        profiles.push_back(makeProfile("lora", 60, 20, 0.05, 0.01, 0.01));
+    }
+
+    printf("COUNT=%d TIMEOUT=%d.%06ds handshakes=%d publishes=%d seed=%u clock=%s\n\n",
+           COUNT, TIMEOUT_SEC, TIMEOUT_MIC, handshakes, publishes, seed, clockSource());
+    printf("%-10s %6s %6s %6s %6s %6s | %7s %9s %9s %9s | %9s %9s %11s | %s\n",
+           "profile", "delay", "jitter", "loss", "dup", "reord",
+           "done", "mean(ms)", "p50(ms)", "p99(ms)",
+           "acked", "msg/s", "bytes/s", "drop/dup/reord");
+
+    for (Profile &profile : profiles)
+    {
+        Result result = run(profile, handshakes, publishes, seed);
+        report(profile, result);
+    }
+
+    return 0;
+}
@@ -0,0 +1,488 @@
+/*  Load Generator
+    Simula uma frota de dispositivos IoT em um único processo: cada
+    dispositivo é um AuthClient rodando em uma fibra sobre um socket UDP
+    não bloqueante, e todas as fibras compartilham um único event loop.
+
+    A taxa de conexões oferecida começa em -r e é multiplicada por --ramp a
+    cada degrau. Cada dispositivo conectado publica a --publish-rate
+    mensagens por segundo durante --lifetime segundos e então desconecta.
+    O ponto de saturação é o primeiro degrau em que a taxa de handshakes
+    concluídos fica abaixo de --completion ou o p99 passa de --slo.
+
+    Uso: ./loadgen [-a endereço] [--port porta] [-d dispositivos] [-r conexões/s]
+                   [--ramp fator] [--steps n] [--step-time s]
+                   [--publish-rate msg/s] [--payload bytes] [--lifetime s]
+                   [--slo ms] [--completion fração] [-s seed] [-o saida.json]
+                   [--trace arquivo] [--crypto-workers n]
+
+    Com --crypto-workers, o RSA dos handshakes roda em um pool de n threads
+    (Event/WorkerPool) e as fibras só aguardam o resultado, sem travar o
+    event loop e as publicações dos outros dispositivos. O Servidor local
+    recebe outras n threads para o seu RSA (Event/SessionScheduler).
+
+    Sem -a, um AuthServer é iniciado no próprio processo (127.0.0.1) e as
+    métricas do lado do Servidor (metrics/) também são reportadas.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "../Auth/AuthClient.h"
+#include "../Event/EventLoop.h"
+#include "../Event/SessionScheduler.h"
+#include "../metrics/metrics.h"
+#include "../Socket/FiberUDPSocket.h"
+
+#define STATUSES (NOT_CONNECTED + 1)
+
+static const char *statusName[STATUSES] = {"OK", "DENIED", "TIMEOUT", "NO_REPLY", "NONCE_INVALID",
+                                           "FDR_INVALID", "HASH_INVALID", "FINISHED", "NOT_CONNECTED"};
+
+typedef struct options
+{
+    const char *address = NULL;
+    int port = DEFAULT_PORT;
+    int devices = 1000;
+    double rate = 10;           /* Conexões por segundo no primeiro degrau. */
+    double ramp = 2;
+    int steps = 6;
+    double stepTime = 10;       /* Em segundos. */
+    double publishRate = 1;     /* Publicações por segundo, por dispositivo. */
+    int payload = 64;
+    double lifetime = 5;        /* Em segundos. */
+    double slo = 1000;          /* p99 máximo do handshake, em ms. */
+    double completion = 0.95;
+    unsigned seed = 1;
+    const char *output = "loadgen.json";
+    const char *trace = NULL;
+    int cryptoWorkers = 0;      /* 0 faz o RSA na própria thread do event loop. */
+} Options;
+
+typedef struct step
+{
+    double rate;
+    int offered = 0;            /* Conexões iniciadas. */
+    int starved = 0;            /* Conexões não iniciadas por falta de dispositivo livre. */
+    int failures[STATUSES] = {0};
+    std::vector<double> handshakes;   /* Em ms. */
+    int published = 0;
+    int acknowledged = 0;
+    int dropped = 0;            /* Sessões perdidas antes do fim do tempo de vida. */
+    std::vector<double> publishes;    /* Em ms. */
+} Step;
+
+typedef struct device
+{
+    FiberUDPSocket socket;
+    BasicAuthClient<QuietPolicy> client;
+    Fiber *fiber = NULL;
+    int step = 0;
+
+    device(EventLoop *loop) : socket(loop), client(&socket) {}
+} Device;
+
+static Options options;
+static std::vector<Step> steps;
+static std::vector<std::unique_ptr<Device>> devices;
+static std::vector<Device *> idle;
+static bool finished = false;
+static std::mt19937 rng;
+
+static double elapsedMs(long long start)
+{
+    return (EventLoop::now() - start) / 1000.0;
+}
+
+/*  Uma sessão completa de um dispositivo: handshake, publicações durante
+    o tempo de vida e desconexão. O resultado vai para o degrau em que a
+    conexão foi iniciada.
+*/
+static void session(EventLoop *loop, Device *device, char *address, char *data)
+{
+    Step &step = steps[device->step];
+    BasicAuthClient<QuietPolicy> &client = device->client;
+
+    long long start = EventLoop::now();
+    const int result = client.connect(address, options.port);
+
+    if (!client.isConnected())
+    {
+        step.failures[result >= 0 && result < STATUSES ? result : DENIED]++;
+
+        /* Avisa o Servidor e abandona o socket; a próxima sessão abre outro. */
+        device->socket.send(DONE_MESSAGE, sizeof(DONE_MESSAGE));
+        device->socket.finish();
+        return;
+    }
+    step.handshakes.push_back(elapsedMs(start));
+
+    std::uniform_real_distribution<double> jitter(0.5, 1.5);
+    const long long end = start + (long long)(options.lifetime * 1000000);
+    const double interval = options.publishRate > 0 ? 1000000 / options.publishRate : 0;
+
+    while (!finished)
+    {
+        /* Sem publicações, ou quando a próxima cairia depois do fim, dorme só até o fim da sessão. */
+        const long long next = interval > 0 ? EventLoop::now() + (long long)(interval * jitter(rng)) : end;
+        loop->sleep((long)(std::min(next, end) - EventLoop::now()));
+        if (finished || EventLoop::now() >= end)
+            break;
+
+        if (!client.isConnected())
+        {
+            step.dropped++;
+            device->socket.finish();
+            return;
+        }
+
+        start = EventLoop::now();
+        step.published++;
+        if (client.publish(data, options.payload) == OK)
+        {
+            step.acknowledged++;
+            step.publishes.push_back(elapsedMs(start));
+        }
+    }
+
+    if (client.isConnected())
+        client.disconnect();
+}
+
+static void deviceLoop(EventLoop *loop, Device *device, char *address)
+{
+    char data[MAX_PAYLOAD];
+    memset(data, 'x', sizeof(data));
+
+    device->fiber = Fiber::current();
+
+    while (!finished)
+    {
+        idle.push_back(device);
+        loop->suspend();
+        if (finished)
+            return;
+
+        session(loop, device, address, data);
+    }
+}
+
+/*  Acorda dispositivos livres na taxa de cada degrau. */
+static void connector(EventLoop *loop)
+{
+    for (size_t s = 0; s < steps.size(); s++)
+    {
+        Step &step = steps[s];
+        const double interval = 1000000 / step.rate;
+        const long long start = EventLoop::now();
+        const long long end = start + (long long)(options.stepTime * 1000000);
+
+        for (long k = 1;; k++)
+        {
+            if (idle.empty())
+                step.starved++;
+            else
+            {
+                Device *device = idle.back();
+                idle.pop_back();
+                device->step = s;
+                step.offered++;
+                loop->wake(device->fiber);
+            }
+
+            const long long next = start + (long long)(k * interval);
+            if (next >= end)
+                break;
+            loop->sleep((long)(next - EventLoop::now()));
+        }
+
+        const long long remaining = end - EventLoop::now();
+        if (remaining > 0)
+            loop->sleep(remaining);
+
+        printf("step %zu: %.1f connects/s offered, %d started, %zu completed\n",
+               s + 1, step.rate, step.offered, step.handshakes.size());
+        fflush(stdout);
+    }
+
+    /* Encerra as sessões em andamento e libera os dispositivos ociosos. */
+    finished = true;
+    for (Device *device : idle)
+        loop->wake(device->fiber);
+    idle.clear();
+}
+
+/*  Cada dispositivo precisa de um descritor: eleva o limite ao máximo permitido. */
+static int raiseFileLimit(int wanted)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return wanted;
+
+    if (limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    const int available = (int)std::min<rlim_t>(limit.rlim_cur, 1 << 30) - 64;
+    return std::min(wanted, available);
+}
+
+static bool saturated(Step &step)
+{
+    if (step.offered == 0)
+        return false;
+
+    std::sort(step.handshakes.begin(), step.handshakes.end());
+    const double completion = (double)step.handshakes.size() / step.offered;
+    return completion < options.completion || percentile(step.handshakes, 0.99) > options.slo;
+}
+
+static bool parse(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+
+        if (!strcmp(argv[i], "-a") && hasValue)
+            options.address = argv[++i];
+        else if (!strcmp(argv[i], "--port") && hasValue)
+            options.port = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-d") && hasValue)
+            options.devices = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && hasValue)
+            options.rate = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--ramp") && hasValue)
+            options.ramp = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--steps") && hasValue)
+            options.steps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--step-time") && hasValue)
+            options.stepTime = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--publish-rate") && hasValue)
+            options.publishRate = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--payload") && hasValue)
+            options.payload = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--lifetime") && hasValue)
+            options.lifetime = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--slo") && hasValue)
+            options.slo = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--completion") && hasValue)
+            options.completion = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && hasValue)
+            options.seed = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && hasValue)
+            options.output = argv[++i];
+        else if (!strcmp(argv[i], "--trace") && hasValue)
+            options.trace = argv[++i];
+        else if (!strcmp(argv[i], "--crypto-workers") && hasValue)
+            options.cryptoWorkers = atoi(argv[++i]);
+        else
+            return false;
+    }
+
+    return options.devices > 0 && options.rate > 0 && options.steps > 0 && options.stepTime > 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (!parse(argc, argv))
+    {
+        fprintf(stderr, "Usage: %s [-a address] [--port port] [-d devices] [-r connects/s] "
+                        "[--ramp factor] [--steps n] [--step-time s] [--publish-rate msg/s] "
+                        "[--payload bytes] [--lifetime s] [--slo ms] [--completion fraction] "
+                        "[-s seed] [-o output.json] [--trace file] [--crypto-workers n]\n", argv[0]);
+        return 1;
+    }
+
+    if (options.payload < 1)
+        options.payload = 1;
+    if (options.payload > MAX_PAYLOAD)
+        options.payload = MAX_PAYLOAD;
+
+    const int wanted = options.devices;
+    options.devices = raiseFileLimit(options.devices);
+    if (options.devices < wanted)
+        fprintf(stderr, "descriptor limit: using %d devices instead of %d\n", options.devices, wanted);
+
+    rng.seed(options.seed);
+
+    if (options.trace != NULL && !trace::start(options.trace))
+        return 1;
+
+    /******************** Servidor local ********************/
+    const bool local = options.address == NULL;
+    char localAddress[] = "127.0.0.1";
+    char *address = local ? localAddress : (char *)options.address;
+
+    UDPSocket serverSocket, stopSocket;
+    std::unique_ptr<BenchServer> server;
+    if (local)
+    {
+        if (options.cryptoWorkers > 0)
+            SessionScheduler::start(options.cryptoWorkers);
+
+        options.port = DEFAULT_PORT;
+        server.reset(new BenchServer(&serverSocket));
+
+        /* Dá tempo para o Servidor abrir o socket antes da primeira conexão. */
+        usleep(100000);
+    }
+
+    /******************** Frota ********************/
+    double rate = options.rate;
+    for (int s = 0; s < options.steps; s++, rate *= options.ramp)
+    {
+        Step step;
+        step.rate = rate;
+        steps.push_back(step);
+    }
+
+    if (options.cryptoWorkers > 0)
+        WorkerPool::start(options.cryptoWorkers);
+
+    EventLoop loop;
+    for (int d = 0; d < options.devices; d++)
+    {
+        devices.push_back(std::unique_ptr<Device>(new Device(&loop)));
+        Device *device = devices.back().get();
+        loop.spawn([&loop, device, address] { deviceLoop(&loop, device, address); });
+    }
+
+    /* Criado por último: roda depois que todos os dispositivos ficaram ociosos. */
+    loop.spawn([&loop] { connector(&loop); });
+
+    printf("target=%s:%d%s devices=%d payload=%d publish-rate=%.2f/s lifetime=%.1fs "
+           "step-time=%.1fs crypto-workers=%d COUNT=%d TIMEOUT=%d.%06ds clock=%s\n\n",
+           address, options.port, local ? " (local)" : "", options.devices, options.payload,
+           options.publishRate, options.lifetime, options.stepTime, options.cryptoWorkers, COUNT, TIMEOUT_SEC, TIMEOUT_MIC, clockSource());
+
+    loop.run();
+
+    if (local)
+    {
+        stopSocket.connect(localAddress, DEFAULT_PORT);
+        server->stop(&stopSocket);
+        stopSocket.finish();
+    }
+
+    WorkerPool::stop();
+    SessionScheduler::stop();
+    trace::stop();
+
+    /******************** Report ********************/
+    int saturation = -1;
+    std::vector<bool> over(steps.size());
+    printf("\n%10s %8s %8s %7s %9s %9s %9s | %9s %9s %9s | %s\n",
+           "offered/s", "started", "starved", "done", "hs/s", "p50(ms)", "p99(ms)",
+           "acked", "pub p50", "pub p99", "failures");
+
+    for (size_t s = 0; s < steps.size(); s++)
+    {
+        Step &step = steps[s];
+        over[s] = saturated(step);
+        if (over[s] && saturation < 0)
+            saturation = s;
+
+        std::sort(step.publishes.begin(), step.publishes.end());
+        const double completion = step.offered ? 100.0 * step.handshakes.size() / step.offered : 0;
+
+        printf("%10.1f %8d %8d %6.1f%% %9.1f %9.2f %9.2f | %4d/%-4d %9.2f %9.2f |",
+               step.rate, step.offered, step.starved, completion,
+               step.handshakes.size() / options.stepTime,
+               percentile(step.handshakes, 0.5), percentile(step.handshakes, 0.99),
+               step.acknowledged, step.published,
+               percentile(step.publishes, 0.5), percentile(step.publishes, 0.99));
+        for (int f = 0; f < STATUSES; f++)
+            if (step.failures[f])
+                printf(" %s=%d", statusName[f], step.failures[f]);
+        if (step.dropped)
+            printf(" dropped=%d", step.dropped);
+        printf("%s\n", over[s] ? "  <- saturated" : "");
+    }
+
+    printf("\n");
+    if (saturation < 0)
+        printf("not saturated up to %.1f connects/s\n", steps.back().rate);
+    else if (saturation == 0)
+        printf("saturated already at %.1f connects/s: lower -r\n", steps[0].rate);
+    else
+        printf("saturation between %.1f and %.1f connects/s (sustained %.1f handshakes/s)\n",
+               steps[saturation - 1].rate, steps[saturation].rate,
+               steps[saturation - 1].handshakes.size() / options.stepTime);
+
+    if (local)
+    {
+        const metrics::Snapshot server = metrics::snapshot();
+
+        printf("\nserver side:\n%-18s %8s %10s %10s %10s %10s\n", "time", "count", "p50(ms)", "p99(ms)", "p999(ms)", "max(ms)");
+        for (int t = 0; t < metrics::TIMERS; t++)
+        {
+            const metrics::Summary &m = server.timers[t];
+            printf("%-18s %8llu %10.3f %10.3f %10.3f %10.3f\n", metrics::timerName[t],
+                   (unsigned long long)m.count, m.p50, m.p99, m.p999, m.max);
+        }
+        printf("handshakes:");
+        for (int i = 0; i < METRICS_STATUSES; i++)
+            if (server.statuses[i])
+                printf(" %s=%llu", metrics::statusName[i], (unsigned long long)server.statuses[i]);
+        printf("\nshed:");
+        for (int i = 0; i < metrics::SHED_REASONS; i++)
+            printf(" %s=%llu", metrics::shedName[i], (unsigned long long)server.shed[i]);
+        printf("\n");
+    }
+
+    FILE *out = fopen(options.output, "w");
+    if (out == NULL)
+    {
+        perror(options.output);
+        return 1;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"benchmark\": \"loadgen\",\n");
+    fprintf(out, "  \"target\": \"%s:%d\",\n", address, options.port);
+    fprintf(out, "  \"local_server\": %s,\n", local ? "true" : "false");
+    fprintf(out, "  \"devices\": %d,\n", options.devices);
+    fprintf(out, "  \"payload\": %d,\n", options.payload);
+    fprintf(out, "  \"publish_rate\": %.3f,\n", options.publishRate);
+    fprintf(out, "  \"lifetime_s\": %.3f,\n", options.lifetime);
+    fprintf(out, "  \"step_time_s\": %.3f,\n", options.stepTime);
+    fprintf(out, "  \"crypto_workers\": %d,\n", options.cryptoWorkers);
+    fprintf(out, "  \"saturation_rate\": %.3f,\n", saturation < 0 ? 0 : steps[saturation].rate);
+    fprintf(out, "  \"steps\": [\n");
+    for (size_t s = 0; s < steps.size(); s++)
+    {
+        Step &step = steps[s];
+        fprintf(out, "    {\"offered_rate\": %.3f, \"started\": %d, \"starved\": %d, \"completed\": %zu, "
+                     "\"handshake_p50_ms\": %.6f, \"handshake_p99_ms\": %.6f, "
+                     "\"published\": %d, \"acknowledged\": %d, \"dropped\": %d, "
+                     "\"publish_p50_ms\": %.6f, \"publish_p99_ms\": %.6f, \"failures\": {",
+                step.rate, step.offered, step.starved, step.handshakes.size(),
+                percentile(step.handshakes, 0.5), percentile(step.handshakes, 0.99),
+                step.published, step.acknowledged, step.dropped,
+                percentile(step.publishes, 0.5), percentile(step.publishes, 0.99));
+        for (int f = 0, first = 1; f < STATUSES; f++)
+        {
+            if (!step.failures[f])
+                continue;
+            fprintf(out, "%s\"%s\": %d", first ? "" : ", ", statusName[f], step.failures[f]);
+            first = 0;
+        }
+        fprintf(out, "}, \"saturated\": %s}%s\n", over[s] ? "true" : "false", s + 1 < steps.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    fclose(out);
+
+    printf("\nwritten to %s\n", options.output);
+    return 0;
+}
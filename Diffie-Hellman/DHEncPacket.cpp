@@ -18,7 +18,7 @@ double DHEncPacket::getTP()
 
 void DHEncPacket::setEncryptedExchange(int encryptedExchange[])
 {
-    for (int i = 0; i < sizeof(DHKeyExchange); i++) {
+    for (size_t i = 0; i < wire::size<DHKeyExchange>(); i++) {
         this->encryptedExchange[i] = encryptedExchange[i];
     }
 }
@@ -26,4 +26,13 @@ void DHEncPacket::setEncryptedExchange(int encryptedExchange[])
 void DHEncPacket::setTP(double tp)
 {
     this->tp = tp;
+}
+
+size_t DHEncPacket::encodeBody(const int *encryptedExchange, uint8_t *out)
+{
+    static_assert(wire::size<DHKeyExchange>() * wire::size<int>() + wire::size<double>() == wire::size<DHEncPacket>(),
+                  "tp must be the last field on the wire");
+
+    wire::encode(encryptedExchange, wire::size<DHKeyExchange>(), out);
+    return wire::size<DHEncPacket>() - wire::size<double>();
 }
\ No newline at end of file
@@ -17,8 +17,19 @@ class DHEncPacket
         void setTP(double tp);
 
     private:
-        int encryptedExchange[sizeof(DHKeyExchange)];
+        /* Um inteiro por byte da codificação do DHKeyExchange. */
+        int encryptedExchange[wire::size<DHKeyExchange>()];
         double tp;
+
+    public:
+        /* Campos na ordem em que vão para a rede (wire.h). */
+        typedef wire::Fields<WIRE_FIELD(DHEncPacket, encryptedExchange), WIRE_FIELD(DHEncPacket, tp)> Wire;
+
+        /*  Codifica a troca cifrada direto de onde está, sem montar o objeto;
+            o tempo de processamento, último campo, é enviado à parte.
+            Retorna os bytes escritos.
+        */
+        static size_t encodeBody(const int *encryptedExchange, uint8_t *out);
 };
 
 #endif
\ No newline at end of file
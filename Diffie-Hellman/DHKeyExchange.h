@@ -23,6 +23,9 @@ class DHKeyExchange
         int encryptedHash[128];
         DiffieHellmanPackage diffieHellmanPackage;
 
+    public:
+        /* Campos na ordem em que vão para a rede (wire.h). */
+        typedef wire::Fields<WIRE_FIELD(DHKeyExchange, encryptedHash), WIRE_FIELD(DHKeyExchange, diffieHellmanPackage)> Wire;
 };
 
 #endif
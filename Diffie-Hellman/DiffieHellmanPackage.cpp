@@ -16,12 +16,12 @@ int DiffieHellmanPackage::getModulus()
     return p;
 }
 
-char *DiffieHellmanPackage::getNonceA()
+Nonce DiffieHellmanPackage::getNonceA()
 {
     return nonceA;
 }
 
-char *DiffieHellmanPackage::getNonceB()
+Nonce DiffieHellmanPackage::getNonceB()
 {
     return nonceB;
 }
@@ -31,14 +31,14 @@ int DiffieHellmanPackage::getIV()
     return iv;
 }
 
-void DiffieHellmanPackage::setNonceA(char *nonce)
+void DiffieHellmanPackage::setNonceA(Nonce nonce)
 {
-    strncpy(nonceA, nonce, sizeof(nonceA));
+    nonceA = nonce;
 }
 
-void DiffieHellmanPackage::setNonceB(char *nonce)
+void DiffieHellmanPackage::setNonceB(Nonce nonce)
 {
-    strncpy(nonceB, nonce, sizeof(nonceB));
+    nonceB = nonce;
 }
 
 void DiffieHellmanPackage::setResult(int r)
@@ -61,6 +61,17 @@ void DiffieHellmanPackage::setIV(int iv)
     this->iv = iv;
 }
 
+void DiffieHellmanPackage::hash(SHA512 *sha)
+{
+    canonical::tag(sha, "DH01");
+    canonical::i32(sha, result);
+    canonical::i32(sha, g);
+    canonical::i32(sha, p);
+    canonical::i32(sha, iv);
+    canonical::bytes(sha, nonceA.bytes, NONCE_SIZE);
+    canonical::bytes(sha, nonceB.bytes, NONCE_SIZE);
+}
+
 std::string DiffieHellmanPackage::toString()
 {
     std::string result = std::to_string(getResult()) + ":" +
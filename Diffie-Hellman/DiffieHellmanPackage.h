@@ -4,6 +4,10 @@
 #include <string.h>
 #include <string>
 
+#include "../settings.h"
+#include "../SHA/Canonical.h"
+#include "../wire.h"
+
 using namespace std;
 
 class DiffieHellmanPackage
@@ -15,8 +19,8 @@ class DiffieHellmanPackage
         int getBase();
         int getModulus();
 
-        char *getNonceA();
-        char *getNonceB();
+        Nonce getNonceA();
+        Nonce getNonceB();
 
         int getIV();
 
@@ -25,13 +29,16 @@ class DiffieHellmanPackage
         void setBase(int base);
         void setModulus(int modulus);
 
-        void setNonceA(char *nonce);
-        void setNonceB(char *nonce);
+        void setNonceA(Nonce nonce);
+        void setNonceB(Nonce nonce);
 
         void setIV(int iv);
 
         std::string toString();
 
+        /* Escreve a codificação canônica do pacote no contexto SHA-512. */
+        void hash(SHA512 *sha);
+
     private:
         int result      = 0;
         int g           = 0;    // Base
@@ -39,8 +46,14 @@ class DiffieHellmanPackage
 
         int iv;
 
-        char nonceA[129];
-        char nonceB[129];
+        Nonce nonceA;
+        Nonce nonceB;
+
+    public:
+        /* Campos na ordem em que vão para a rede (wire.h). */
+        typedef wire::Fields<WIRE_FIELD(DiffieHellmanPackage, result), WIRE_FIELD(DiffieHellmanPackage, g),
+                             WIRE_FIELD(DiffieHellmanPackage, p), WIRE_FIELD(DiffieHellmanPackage, iv),
+                             WIRE_FIELD(DiffieHellmanPackage, nonceA), WIRE_FIELD(DiffieHellmanPackage, nonceB)> Wire;
 };
 
 #endif
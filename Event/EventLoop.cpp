@@ -0,0 +1,218 @@
+#include "EventLoop.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "../time.h"
+
+#define MAX_EVENTS 256
+
+static thread_local EventLoop *active = NULL;
+
+EventLoop::EventLoop()
+{
+    epfd = epoll_create1(0);
+    if (epfd < 0)
+        perror("epoll_create1");
+
+    /* Registered for good; a NULL data.ptr tells it apart from fiber waits. */
+    postfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (postfd < 0 || epoll_ctl(epfd, EPOLL_CTL_ADD, postfd, &event) < 0)
+        perror("eventfd");
+}
+
+EventLoop::~EventLoop()
+{
+    for (Fiber *fiber : fibers)
+        delete fiber;
+    close(postfd);
+    close(epfd);
+}
+
+long long EventLoop::now()
+{
+    return nanoTime() / 1000;
+}
+
+EventLoop *EventLoop::current()
+{
+    return active;
+}
+
+void EventLoop::spawn(std::function<void()> body)
+{
+    Fiber *fiber = new Fiber(body);
+    fibers.insert(fiber);
+    ready.push_back(fiber);
+}
+
+void EventLoop::stop()
+{
+    stopped = true;
+}
+
+void EventLoop::run()
+{
+    EventLoop *previous = active;
+    active = this;
+
+    struct epoll_event events[MAX_EVENTS];
+
+    while (!stopped && !fibers.empty())
+    {
+        runReady();
+        if (stopped || fibers.empty())
+            break;
+
+        int timeout = -1;
+        if (!ready.empty())
+            timeout = 0;
+        else if (!timers.empty())
+        {
+            const long long wait = timers.top().deadline - now();
+            timeout = wait > 0 ? (int)((wait + 999) / 1000) : 0;
+        }
+
+        const int n = epoll_wait(epfd, events, MAX_EVENTS, timeout);
+        if (n < 0 && errno != EINTR)
+        {
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.ptr == NULL)
+                drainPosted();
+            else
+                release((Wait *)events[i].data.ptr, true);
+        }
+
+        fireTimers();
+    }
+
+    active = previous;
+}
+
+void EventLoop::runReady()
+{
+    /* Fibers readied while this batch runs wait for the next iteration. */
+    size_t batch = ready.size();
+    while (batch-- && !ready.empty())
+    {
+        Fiber *fiber = ready.front();
+        ready.pop_front();
+
+        fiber->resume();
+        if (fiber->finished())
+        {
+            fibers.erase(fiber);
+            delete fiber;
+        }
+    }
+}
+
+void EventLoop::fireTimers()
+{
+    const long long time = now();
+    while (!timers.empty() && timers.top().deadline <= time)
+    {
+        auto it = pending.find(timers.top().id);
+        timers.pop();
+        if (it != pending.end())
+            release(it->second, false);
+    }
+}
+
+void EventLoop::park(Wait *wait, long timeout_us)
+{
+    wait->fiber = Fiber::current();
+    wait->id = nextId++;
+    wait->readable = false;
+
+    pending[wait->id] = wait;
+    if (timeout_us > 0)
+        timers.push({now() + timeout_us, wait->id});
+
+    Fiber::yield();
+}
+
+/* Each wait is released once; later events or timers for it are ignored. */
+void EventLoop::release(Wait *wait, bool readable)
+{
+    if (pending.erase(wait->id) == 0)
+        return;
+
+    wait->readable = readable;
+    ready.push_back(wait->fiber);
+}
+
+bool EventLoop::waitReadable(int fd, long timeout_us)
+{
+    Wait wait;
+
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.ptr = &wait;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) < 0)
+        return false;
+
+    park(&wait, timeout_us);
+
+    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+    return wait.readable;
+}
+
+void EventLoop::sleep(long us)
+{
+    Wait wait;
+    park(&wait, us > 0 ? us : 1);
+}
+
+void EventLoop::suspend()
+{
+    Fiber *fiber = Fiber::current();
+    suspended.insert(fiber);
+    Fiber::yield();
+}
+
+void EventLoop::wake(Fiber *fiber)
+{
+    if (suspended.erase(fiber))
+        ready.push_back(fiber);
+}
+
+void EventLoop::post(Fiber *fiber)
+{
+    {
+        std::lock_guard<std::mutex> guard(postLock);
+        posted.push_back(fiber);
+    }
+
+    const uint64_t one = 1;
+    if (write(postfd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        perror("eventfd write");
+}
+
+void EventLoop::drainPosted()
+{
+    uint64_t count;
+    if (read(postfd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        perror("eventfd read");
+
+    std::vector<Fiber *> batch;
+    {
+        std::lock_guard<std::mutex> guard(postLock);
+        batch.swap(posted);
+    }
+
+    for (Fiber *fiber : batch)
+        wake(fiber);
+}
@@ -0,0 +1,86 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Fiber.h"
+
+/*  Single-threaded scheduler for fibers blocked on sockets or timers.
+    Fibers park with waitReadable()/sleep()/suspend() and the loop resumes
+    them when epoll reports the descriptor, the deadline passes or another
+    fiber calls wake().
+*/
+class EventLoop
+{
+
+  public:
+    EventLoop();
+    ~EventLoop();
+
+    /* Creates a fiber that starts running on the next loop iteration. */
+    void spawn(std::function<void()> body);
+    /* Runs until every fiber finishes or stop() is called. */
+    void run();
+    void stop();
+
+    /* Monotonic time in microseconds. */
+    static long long now();
+    /* Loop running on this thread, or NULL. */
+    static EventLoop *current();
+
+    /*  The calls below must be made from a fiber of this loop. */
+
+    /* Returns true when 'fd' is readable, false after timeout_us (0 waits forever). */
+    bool waitReadable(int fd, long timeout_us);
+    void sleep(long us);
+    /* Parks the fiber until wake() is called for it. */
+    void suspend();
+    void wake(Fiber *fiber);
+
+    /* Thread-safe wake(): may be called from any thread, e.g. a WorkerPool job. */
+    void post(Fiber *fiber);
+
+  private:
+    typedef struct wait
+    {
+        Fiber *fiber;
+        unsigned long id;
+        bool readable;
+    } Wait;
+
+    typedef struct timer
+    {
+        long long deadline;
+        unsigned long id;
+        bool operator>(const timer &other) const { return deadline > other.deadline; }
+    } Timer;
+
+    int epfd;
+    int postfd;         /* eventfd signalled by post(). */
+    bool stopped = false;
+    unsigned long nextId = 1;
+
+    std::unordered_set<Fiber *> fibers;
+    std::unordered_set<Fiber *> suspended;
+    std::deque<Fiber *> ready;
+    std::unordered_map<unsigned long, Wait *> pending;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+
+    std::mutex postLock;
+    std::vector<Fiber *> posted;
+
+    /* Parks the current fiber on 'wait' until a descriptor or timer releases it. */
+    void park(Wait *wait, long timeout_us);
+    void release(Wait *wait, bool readable);
+    void runReady();
+    void fireTimers();
+    void drainPosted();
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "Fiber.h"
+
+#include <stdint.h>
+
+static thread_local Fiber *running = NULL;
+
+Fiber::Fiber(std::function<void()> body, size_t stackSize)
+    : body(body)
+{
+    stack = new char[stackSize];
+
+    getcontext(&context);
+    context.uc_stack.ss_sp = stack;
+    context.uc_stack.ss_size = stackSize;
+    context.uc_link = &caller;
+
+    /* makecontext only passes ints: split the pointer in two halves. */
+    const uintptr_t self = (uintptr_t)this;
+    makecontext(&context, (void (*)())trampoline, 2,
+                (unsigned)((uint64_t)self >> 32), (unsigned)(self & 0xffffffff));
+}
+
+Fiber::~Fiber()
+{
+    delete[] stack;
+}
+
+void Fiber::trampoline(unsigned high, unsigned low)
+{
+    Fiber *fiber = (Fiber *)(uintptr_t)(((uint64_t)high << 32) | low);
+    fiber->body();
+    fiber->done = true;
+    /* Returning follows uc_link back to the resumer. */
+}
+
+void Fiber::resume()
+{
+    if (done)
+        return;
+
+    Fiber *previous = running;
+    running = this;
+    swapcontext(&caller, &context);
+    running = previous;
+}
+
+bool Fiber::finished()
+{
+    return done;
+}
+
+void Fiber::yield()
+{
+    Fiber *self = running;
+    if (self != NULL)
+        swapcontext(&self->context, &self->caller);
+}
+
+Fiber *Fiber::current()
+{
+    return running;
+}
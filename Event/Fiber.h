@@ -0,0 +1,40 @@
+#ifndef FIBER_H
+#define FIBER_H
+
+#include <stddef.h>
+#include <ucontext.h>
+#include <functional>
+
+#define FIBER_STACK_SIZE (128 * 1024)
+
+/*  Cooperative user-space thread. A fiber runs on its own stack until it
+    calls yield(), which switches back to whoever called resume().
+    Exceptions must not escape the body.
+*/
+class Fiber
+{
+
+  public:
+    Fiber(std::function<void()> body, size_t stackSize = FIBER_STACK_SIZE);
+    ~Fiber();
+
+    /* Runs the fiber until it yields or finishes. */
+    void resume();
+    bool finished();
+
+    /* Called from inside a fiber: switches back to the resumer. */
+    static void yield();
+    /* Fiber running on this thread, or NULL outside of any fiber. */
+    static Fiber *current();
+
+  private:
+    std::function<void()> body;
+    char *stack;
+    ucontext_t context;
+    ucontext_t caller;
+    bool done = false;
+
+    static void trampoline(unsigned high, unsigned low);
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "SessionScheduler.h"
+
+#include <atomic>
+
+/* Tasks a strand runs before giving its worker back to the pool. */
+#define STRAND_BATCH 16
+
+static std::atomic<SessionScheduler *> scheduler(NULL);
+/* Servers on several threads may start the shared scheduler at once. */
+static std::mutex sharedLock;
+
+SessionScheduler::SessionScheduler(int threads)
+    : pool(threads)
+{
+}
+
+void SessionScheduler::post(uint32_t session, std::function<void()> task)
+{
+    Shard &shard = shards[session % SHARDS];
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        Strand &strand = shard.strands[session];
+        strand.tasks.push_back(std::move(task));
+        if (strand.queued)
+            return;
+        strand.queued = true;
+    }
+
+    pool.submit([this, session] { drain(session); });
+}
+
+void SessionScheduler::run(uint32_t session, const std::function<void()> &task)
+{
+    if (WorkerPool::inWorker())
+    {
+        task();
+        return;
+    }
+
+    await([this, session](std::function<void()> wrapped) { post(session, std::move(wrapped)); }, task);
+}
+
+void SessionScheduler::drain(uint32_t session)
+{
+    Shard &shard = shards[session % SHARDS];
+
+    for (int i = 0; i < STRAND_BATCH; i++)
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            auto strand = shard.strands.find(session);
+            if (strand->second.tasks.empty())
+            {
+                /* Nothing left: forget the session so idle ones cost no memory. */
+                shard.strands.erase(strand);
+                return;
+            }
+            task = std::move(strand->second.tasks.front());
+            strand->second.tasks.pop_front();
+        }
+        task();
+    }
+
+    /* Still queued: go behind the other strands waiting on this worker, where idle workers steal first. */
+    pool.yield([this, session] { drain(session); });
+}
+
+void SessionScheduler::start(int threads)
+{
+    std::lock_guard<std::mutex> guard(sharedLock);
+    if (scheduler.load(std::memory_order_relaxed) == NULL)
+        scheduler.store(new SessionScheduler(threads), std::memory_order_release);
+}
+
+void SessionScheduler::stop()
+{
+    std::lock_guard<std::mutex> guard(sharedLock);
+    delete scheduler.exchange(NULL);
+}
+
+SessionScheduler *SessionScheduler::shared()
+{
+    return scheduler;
+}
+
+void offload(uint32_t session, const std::function<void()> &job)
+{
+    SessionScheduler *const shared = scheduler.load(std::memory_order_acquire);
+    if (shared == NULL || session == 0)
+        offload(job);
+    else
+        shared->run(session, job);
+}
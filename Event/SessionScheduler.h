@@ -0,0 +1,73 @@
+#ifndef SESSION_SCHEDULER_H
+#define SESSION_SCHEDULER_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+
+#include "WorkerPool.h"
+
+/*  Runs session events on a WorkerPool while keeping each session's events
+    in the order they were posted. Every session is a strand: at most one of
+    its tasks runs at a time, and the strand is queued on the pool only while
+    it has work. A busy strand yields its worker after a batch of tasks and
+    goes behind the jobs already waiting, so one slow handshake does not hold
+    up the cheap events of other sessions. Strands are spread over shards,
+    each with its own lock, so sessions on different shards never contend.
+*/
+class SessionScheduler
+{
+
+  public:
+    SessionScheduler(int threads);
+
+    /* Queues 'task' after every task already posted for 'session'. */
+    void post(uint32_t session, std::function<void()> task);
+
+    /*  Posts 'task' for 'session' and returns once it has finished, waiting
+        like WorkerPool::run. On a worker thread the task runs inline.
+    */
+    void run(uint32_t session, const std::function<void()> &task);
+
+    /*  Process-wide scheduler used by offload(session, job); none until
+        start(). Further start() calls keep the running one.
+    */
+    static void start(int threads);
+    static void stop();
+    static SessionScheduler *shared();
+
+  private:
+    typedef struct strand
+    {
+        std::deque<std::function<void()>> tasks;
+        bool queued = false;    /* Owned by a pool job, which will drain it. */
+    } Strand;
+
+    /*  Padded to a multiple of a cache line so neighbouring locks do not
+        share one. Padding rather than alignas: the scheduler is created
+        with new, which does not honour over-alignment before C++17.
+    */
+    typedef struct shard
+    {
+        std::mutex lock;
+        std::unordered_map<uint32_t, Strand> strands;
+        char pad[64 - (sizeof(std::mutex) + sizeof(std::unordered_map<uint32_t, Strand>)) % 64];
+    } Shard;
+
+    static const int SHARDS = 16;
+
+    Shard shards[SHARDS];
+    /* Declared last: destroyed first, running what is still queued while the strands exist. */
+    WorkerPool pool;
+
+    void drain(uint32_t session);
+};
+
+/*  Runs 'job' in the strand of 'session' on the shared scheduler if one was
+    started, and falls back to offload(job) otherwise or for session 0.
+*/
+void offload(uint32_t session, const std::function<void()> &job);
+
+#endif
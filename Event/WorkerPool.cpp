@@ -0,0 +1,181 @@
+#include "WorkerPool.h"
+
+#include "EventLoop.h"
+
+static WorkerPool *pool = NULL;
+
+/* Deque owned by the worker running on this thread, or -1, and the pool it belongs to. */
+static thread_local int owned = -1;
+static thread_local const WorkerPool *owner = NULL;
+
+WorkerPool::WorkerPool(int threads)
+    : pending(0), next(0)
+{
+    if (threads < 1)
+        threads = 1;
+
+    for (int i = 0; i < threads; i++)
+        queues.push_back(new Queue());
+    for (int i = 0; i < threads; i++)
+        workers.push_back(std::thread(&WorkerPool::work, this, i));
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(idleLock);
+        stopping = true;
+    }
+    idle.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+    for (Queue *queue : queues)
+        delete queue;
+}
+
+void WorkerPool::submit(std::function<void()> job)
+{
+    push(std::move(job), false);
+}
+
+void WorkerPool::yield(std::function<void()> job)
+{
+    push(std::move(job), true);
+}
+
+void WorkerPool::push(std::function<void()> job, bool front)
+{
+    /* Jobs spawned by a worker stay on its own deque, where they are hot. */
+    const bool own = owner == this;
+    const int index = own ? owned : (int)(next.fetch_add(1, std::memory_order_relaxed) % queues.size());
+
+    {
+        std::lock_guard<std::mutex> guard(queues[index]->lock);
+        if (front && own)
+            queues[index]->jobs.push_front(std::move(job));
+        else
+            queues[index]->jobs.push_back(std::move(job));
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(idleLock);
+        pending.fetch_add(1, std::memory_order_release);
+    }
+    idle.notify_one();
+}
+
+bool WorkerPool::take(int index, std::function<void()> &job)
+{
+    Queue *own = queues[index];
+    {
+        std::lock_guard<std::mutex> guard(own->lock);
+        if (!own->jobs.empty())
+        {
+            job = std::move(own->jobs.back());
+            own->jobs.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size(); i++)
+    {
+        Queue *victim = queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if (!victim->jobs.empty())
+        {
+            job = std::move(victim->jobs.front());
+            victim->jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkerPool::work(int index)
+{
+    owned = index;
+    owner = this;
+
+    while (true)
+    {
+        std::function<void()> job;
+        if (take(index, job))
+        {
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+            job();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleLock);
+        idle.wait(lock, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+        if (stopping && pending.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
+
+void WorkerPool::run(const std::function<void()> &job)
+{
+    await([this](std::function<void()> wrapped) { submit(std::move(wrapped)); }, job);
+}
+
+void await(const std::function<void(std::function<void()>)> &submit, const std::function<void()> &job)
+{
+    EventLoop *loop = EventLoop::current();
+    Fiber *fiber = Fiber::current();
+
+    if (loop != NULL && fiber != NULL)
+    {
+        /* The fiber cannot resume before suspend(): post() is only seen by the loop after it yields. */
+        submit([&job, loop, fiber] {
+            job();
+            loop->post(fiber);
+        });
+        loop->suspend();
+        return;
+    }
+
+    std::mutex lock;
+    std::condition_variable finished;
+    bool done = false;
+
+    submit([&] {
+        job();
+        std::lock_guard<std::mutex> guard(lock);
+        done = true;
+        finished.notify_one();
+    });
+
+    std::unique_lock<std::mutex> wait(lock);
+    finished.wait(wait, [&] { return done; });
+}
+
+void WorkerPool::start(int threads)
+{
+    if (pool == NULL)
+        pool = new WorkerPool(threads);
+}
+
+void WorkerPool::stop()
+{
+    delete pool;
+    pool = NULL;
+}
+
+WorkerPool *WorkerPool::shared()
+{
+    return pool;
+}
+
+bool WorkerPool::inWorker()
+{
+    return owned >= 0;
+}
+
+void offload(const std::function<void()> &job)
+{
+    if (pool == NULL || owned >= 0)
+        job();
+    else
+        pool->run(job);
+}
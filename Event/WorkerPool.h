@@ -0,0 +1,78 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*  Fixed set of threads for CPU-bound work (RSA, key generation), so the
+    threads doing I/O are not stalled by it. Each worker owns a deque: it
+    takes its own jobs from the back and, when empty, steals from the front
+    of the others. Jobs submitted from outside the pool are spread round
+    robin over the deques.
+*/
+class WorkerPool
+{
+
+  public:
+    WorkerPool(int threads);
+    /* Finishes the queued jobs and joins the workers. */
+    ~WorkerPool();
+
+    void submit(std::function<void()> job);
+
+    /*  Queues 'job' behind the jobs already waiting. From a worker it goes
+        to the front of its deque: the end the worker takes last and
+        thieves take first. From outside the pool it is the same as submit().
+    */
+    void yield(std::function<void()> job);
+
+    /*  Runs 'job' on the pool and returns once it has finished. Called from
+        an EventLoop fiber only the fiber waits, so the loop keeps serving
+        the others; from any other thread the thread blocks.
+    */
+    void run(const std::function<void()> &job);
+
+    /* Process-wide pool used by offload(); none until start(). */
+    static void start(int threads);
+    static void stop();
+    static WorkerPool *shared();
+
+    /* True on a thread of any WorkerPool. */
+    static bool inWorker();
+
+  private:
+    typedef struct queue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> jobs;
+    } Queue;
+
+    std::vector<Queue *> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex idleLock;
+    std::condition_variable idle;
+    std::atomic<int> pending;
+    std::atomic<unsigned> next;
+    bool stopping = false;
+
+    void push(std::function<void()> job, bool front);
+    void work(int index);
+    bool take(int index, std::function<void()> &job);
+};
+
+/*  Hands 'job' to 'submit' and returns once it has finished. Called from an
+    EventLoop fiber only the fiber waits; from any other thread the thread
+    blocks. Shared by WorkerPool::run and SessionScheduler::run.
+*/
+void await(const std::function<void(std::function<void()>)> &submit, const std::function<void()> &job);
+
+/* Runs 'job' on the shared pool if one was started, inline otherwise. */
+void offload(const std::function<void()> &job);
+
+#endif
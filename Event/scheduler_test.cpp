@@ -0,0 +1,143 @@
+/*  SessionScheduler Test
+    Checks that the scheduler keeps each session's tasks in order, never
+    runs two tasks of one session at once, and does not let a busy session
+    starve the others.
+
+    Usage: ./scheduler_test
+    Prints one line per check and exits with 1 if any of them fails.
+*/
+
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SessionScheduler.h"
+
+/* STRAND_BATCH in SessionScheduler.cpp. */
+#define BATCH 16
+
+static int failures = 0;
+
+static void check(bool passed, const char *name)
+{
+    printf("%-40s %s\n", name, passed ? "ok" : "FAIL");
+    if (!passed)
+        failures++;
+}
+
+/*  One worker, a session with many tasks already running, and a second
+    session posting a single task: the second one must run once the first
+    yields its batch, not after all of its tasks.
+*/
+static void fairness()
+{
+    const int tasks = 8 * BATCH;
+
+    std::mutex lock;
+    std::vector<uint32_t> order;
+    std::atomic<bool> started(false), posted(false);
+
+    {
+        SessionScheduler scheduler(1);
+
+        for (int i = 0; i < tasks; i++)
+        {
+            scheduler.post(1, [&, i] {
+                /* Holds the worker until session 2 is queued behind it. */
+                started = true;
+                while (i == 0 && !posted)
+                    std::this_thread::yield();
+                std::lock_guard<std::mutex> guard(lock);
+                order.push_back(1);
+            });
+        }
+
+        while (!started)
+            std::this_thread::yield();
+        scheduler.post(2, [&] {
+            std::lock_guard<std::mutex> guard(lock);
+            order.push_back(2);
+        });
+        posted = true;
+    }
+
+    int position = -1;
+    for (size_t i = 0; i < order.size(); i++)
+        if (order[i] == 2)
+            position = i;
+
+    printf("session 2 ran after %d of %d tasks of session 1\n", position, tasks);
+    check(order.size() == (size_t)tasks + 1, "fairness: every task ran");
+    check(position >= 0 && position <= BATCH, "fairness: no starvation behind a batch");
+}
+
+/*  Many sessions posted interleaved over several workers: each one must
+    see its tasks in order and one at a time, while workers steal strands.
+*/
+static void ordering()
+{
+    const int sessions = 64;
+    const int tasks = 1000;
+
+    std::vector<int> next(sessions, 0);
+    std::vector<std::atomic<int>> running(sessions);
+    std::atomic<int> misordered(0), overlapped(0);
+
+    for (std::atomic<int> &r : running)
+        r = 0;
+
+    {
+        SessionScheduler scheduler(4);
+
+        for (int i = 0; i < tasks; i++)
+        {
+            for (int s = 0; s < sessions; s++)
+            {
+                scheduler.post(s + 1, [&, s, i] {
+                    if (running[s].fetch_add(1) != 0)
+                        overlapped++;
+                    if (next[s] != i)
+                        misordered++;
+                    next[s] = i + 1;
+                    running[s].fetch_sub(1);
+                });
+            }
+        }
+    }
+
+    bool complete = true;
+    for (int s = 0; s < sessions; s++)
+        complete = complete && next[s] == tasks;
+
+    check(complete, "ordering: every task ran");
+    check(misordered == 0, "ordering: tasks in posting order");
+    check(overlapped == 0, "ordering: one task per session at a time");
+}
+
+/*  offload(session, job) runs on the shared scheduler once it is started,
+    and inline before that.
+*/
+static void shared()
+{
+    const std::thread::id caller = std::this_thread::get_id();
+    std::thread::id ran;
+
+    offload(7, [&] { ran = std::this_thread::get_id(); });
+    check(ran == caller, "offload: inline without a scheduler");
+
+    SessionScheduler::start(2);
+    offload(7, [&] { ran = std::this_thread::get_id(); });
+    check(ran != caller, "offload: on the shared scheduler");
+    SessionScheduler::stop();
+}
+
+int main()
+{
+    fairness();
+    ordering();
+    shared();
+
+    return failures ? 1 : 0;
+}
@@ -1,4 +1,5 @@
 #include "RSA.h"
+#include "../random.h"
 
 //Codifica uma string de caracteres usando o resto da divisão de a^e por n para cada caractere, para a é utilizado o código da tabela ASCII
 void RSA::codifica(int encrypted[], char *mensagem, int e, int n, int quant){
@@ -65,7 +66,7 @@ int RSA::expModular(int a, int b, int n){
 }
 
 long RSA::geraNumeroMax(int n){
-    return rand() % n + 1;
+    return csprng::uniform(n) + 1;
 }
 
 long RSA::geraNumeroRandom(){
@@ -73,7 +74,7 @@ long RSA::geraNumeroRandom(){
 	res = to_hex(10);
 	printf("\n NUMERO:10 RES: %c \n", res);*/
 
-    return rand() % 100;
+    return csprng::uniform(100);
 }
 
 
@@ -83,6 +84,10 @@ long long RSA::verificaPrimo(long long p){
 	long long i;
 	double j;
 
+	//0 e 1 não são primos
+	if(p < 2)
+		return 0;
+
 	//Calcula a raiz quadrada para p
 	j = sqrt(p);
 
@@ -100,6 +105,11 @@ long long RSA::verificaPrimo(long long p){
 // GERAR NOVO PRIMO
 long RSA::geraPrimo(long numero){
     long primo;
+
+    //Garante um intervalo que contenha ao menos um primo
+    if(numero < 2)
+        numero = 2;
+
     primo = geraNumeroRandom();
     while(verificaPrimo(primo) != 1){/*Em quanto primalidade não for igual a 1 que é verdadeiro*/
         primo = geraNumeroMax(numero); /*Gerando numero aleatorio entre 1 e X*/
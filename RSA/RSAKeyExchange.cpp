@@ -30,4 +30,15 @@ void RSAKeyExchange::setEncryptedHash(int encryptedHash[])
 void RSAKeyExchange::setProcessingTime(double tp)
 {
     this->tp = tp;
+}
+
+size_t RSAKeyExchange::encodeBody(const RSAPackage &rsaPackage, const int *encryptedHash, uint8_t *out)
+{
+    const size_t hashes = sizeof(RSAKeyExchange::encryptedHash) / sizeof(int);
+    static_assert(wire::size<RSAPackage>() + hashes * wire::size<int>() + wire::size<double>() == wire::size<RSAKeyExchange>(),
+                  "tp must be the last field on the wire");
+
+    wire::encode(rsaPackage, out);
+    wire::encode(encryptedHash, hashes, out + wire::size<RSAPackage>());
+    return wire::size<RSAKeyExchange>() - wire::size<double>();
 }
\ No newline at end of file
@@ -24,6 +24,16 @@ class RSAKeyExchange
         int encryptedHash[128];
         double tp;
 
+    public:
+        /* Campos na ordem em que vão para a rede (wire.h). */
+        typedef wire::Fields<WIRE_FIELD(RSAKeyExchange, rsaPackage), WIRE_FIELD(RSAKeyExchange, encryptedHash),
+                             WIRE_FIELD(RSAKeyExchange, tp)> Wire;
+
+        /*  Codifica os campos que precedem o tempo de processamento direto de
+            onde estão, sem montar o objeto; o tempo, último campo, é enviado
+            à parte. Retorna os bytes escritos.
+        */
+        static size_t encodeBody(const RSAPackage &rsaPackage, const int *encryptedHash, uint8_t *out);
 };
 
 #endif
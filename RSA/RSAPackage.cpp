@@ -1,4 +1,5 @@
 #include "RSAPackage.h"
+#include "../utils.h"
 
 RSAKey RSAPackage::getPublicKey()
 {
@@ -15,12 +16,12 @@ int RSAPackage::getAnswerFDR()
     return answerFDR;
 }
 
-char *RSAPackage::getNonceA()
+Nonce RSAPackage::getNonceA()
 {
     return nonceA;
 }
 
-char *RSAPackage::getNonceB()
+Nonce RSAPackage::getNonceB()
 {
     return nonceB;
 }
@@ -45,14 +46,14 @@ void RSAPackage::setAnswerFDR(int answerFDR)
     this->answerFDR = answerFDR;
 }
 
-void RSAPackage::setNonceA(char *nonce)
+void RSAPackage::setNonceA(Nonce nonce)
 {
-    strncpy(nonceA, nonce, sizeof(nonceA));
+    nonceA = nonce;
 }
 
-void RSAPackage::setNonceB(char *nonce)
+void RSAPackage::setNonceB(Nonce nonce)
 {
-    strncpy(nonceB, nonce, sizeof(nonceB));
+    nonceB = nonce;
 }
 
 void RSAPackage::setACK()
@@ -60,13 +61,25 @@ void RSAPackage::setACK()
     ack = ACK;
 }
 
+void RSAPackage::hash(SHA512 *sha)
+{
+    canonical::tag(sha, "RSA1");
+    canonical::i32(sha, publicKey.d);
+    canonical::i32(sha, publicKey.n);
+    canonical::i32(sha, answerFDR);
+    canonical::u8(sha, fdr.getOperator());
+    canonical::i32(sha, fdr.getOperand());
+    canonical::bytes(sha, nonceA.bytes, NONCE_SIZE);
+    canonical::bytes(sha, nonceB.bytes, NONCE_SIZE);
+}
+
 string RSAPackage::toString()
 {
     std::string result =    std::to_string(publicKey.d)    + " | " +
                         std::to_string(publicKey.n)    + " | " +
                         std::to_string(answerFDR)      + " | " +
                         fdr.toString()                 + " | " + 
-                        nonceA                         + " | " +
-                        nonceB;
+                        Uint8_tToHexString(nonceA.bytes, NONCE_SIZE) + " | " +
+                        Uint8_tToHexString(nonceB.bytes, NONCE_SIZE);
     return result;
 }
\ No newline at end of file
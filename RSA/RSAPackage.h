@@ -3,6 +3,7 @@
 
 #include "../settings.h"
 #include "../fdr.h"
+#include "../SHA/Canonical.h"
 #include <string.h>
 
 using namespace std;
@@ -13,26 +14,35 @@ class RSAPackage
         RSAKey getPublicKey();
         FDR getFDR();
         int getAnswerFDR();
-        char *getNonceA();
-        char *getNonceB();
+        Nonce getNonceA();
+        Nonce getNonceB();
         char getACK();
 
         void setPublicKey(RSAKey key);
         void setFDR(FDR fdr);
         void setAnswerFDR(int answerFDR);
-        void setNonceA(char *nonce);
-        void setNonceB(char *nonce);
+        void setNonceA(Nonce nonce);
+        void setNonceB(Nonce nonce);
         void setACK();
 
         string toString();
 
+        /* Escreve a codificação canônica do pacote (sem o ACK) no contexto SHA-512. */
+        void hash(SHA512 *sha);
+
     private:
         RSAKey publicKey;
         FDR fdr;
         int answerFDR = 0;
-        char nonceA[129];
-        char nonceB[129];
+        Nonce nonceA;
+        Nonce nonceB;
         char ack = '-';
+
+    public:
+        /* Campos na ordem em que vão para a rede (wire.h). */
+        typedef wire::Fields<WIRE_FIELD(RSAPackage, publicKey), WIRE_FIELD(RSAPackage, fdr),
+                             WIRE_FIELD(RSAPackage, answerFDR), WIRE_FIELD(RSAPackage, nonceA),
+                             WIRE_FIELD(RSAPackage, nonceB), WIRE_FIELD(RSAPackage, ack)> Wire;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sha512.h"
+
+/*  Codificação canônica dos pacotes do handshake, escrita direto em um
+    contexto SHA-512. Cada campo tem tamanho fixo e ordem de bytes definida
+    (inteiros em big-endian, textos completados com zeros), então os dois
+    lados chegam ao mesmo hash sem montar strings e independente da
+    arquitetura.
+*/
+namespace canonical
+{
+
+inline void u8(SHA512 *sha, uint8_t value)
+{
+    sha->update(&value, 1);
+}
+
+inline void i32(SHA512 *sha, int32_t value)
+{
+    const uint32_t v = (uint32_t)value;
+    const uint8_t bytes[4] = {(uint8_t)(v >> 24), (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v};
+    sha->update(bytes, sizeof(bytes));
+}
+
+/*  Bytes crus, de tamanho fixo (nonces). */
+inline void bytes(SHA512 *sha, const uint8_t *value, size_t size)
+{
+    sha->update(value, size);
+}
+
+/*  Texto em exatamente 'width' bytes: o que vem depois do terminador não entra no hash. */
+inline void text(SHA512 *sha, const char *value, size_t width)
+{
+    static const uint8_t zeros[256] = {0};
+
+    const size_t length = strnlen(value, width);
+    sha->update((const uint8_t *)value, length);
+    for (size_t left = width - length; left > 0;)
+    {
+        const size_t chunk = left < sizeof(zeros) ? left : sizeof(zeros);
+        sha->update(zeros, chunk);
+        left -= chunk;
+    }
+}
+
+/*  Identifica o tipo do pacote, para que dois tipos nunca tenham a mesma codificação. */
+inline void tag(SHA512 *sha, const char (&name)[5])
+{
+    sha->update((const uint8_t *)name, 4);
+}
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include <cstring>
 #include <fstream>
 #include "sha512.h"
+#include "../utils.h"
 
 const unsigned long long SHA512::sha512_k[80] = //ULL = uint64
             {0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL,
@@ -147,9 +148,7 @@ std::string sha512(std::string input)
     ctx.update((unsigned char*)input.c_str(), input.length());
     ctx.final(digest);
 
-    char buf[2*SHA512::DIGEST_SIZE+1];
-    buf[2*SHA512::DIGEST_SIZE] = 0;
-    for (int i = 0; i < SHA512::DIGEST_SIZE; i++)
-        sprintf(buf+i*2, "%02x", digest[i]);
-    return std::string(buf);
+    std::string hex(2*SHA512::DIGEST_SIZE, '\0');
+    hexEncode(digest, SHA512::DIGEST_SIZE, &hex[0], false);
+    return hex;
 }
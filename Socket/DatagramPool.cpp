@@ -0,0 +1,36 @@
+#include "DatagramPool.h"
+
+DatagramPool::DatagramPool()
+{
+}
+
+DatagramPool::~DatagramPool()
+{
+    for (Datagram *datagram : owned)
+        delete datagram;
+}
+
+Datagram *DatagramPool::acquire()
+{
+    Datagram *datagram = idle;
+    if (datagram != NULL)
+        idle = datagram->next;
+    else
+    {
+        datagram = new Datagram();
+        owned.push_back(datagram);
+    }
+
+    datagram->size = 0;
+    datagram->next = NULL;
+    return datagram;
+}
+
+void DatagramPool::release(Datagram *datagram)
+{
+    if (datagram == NULL)
+        return;
+
+    datagram->next = idle;
+    idle = datagram;
+}
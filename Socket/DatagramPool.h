@@ -0,0 +1,53 @@
+#ifndef DATAGRAM_POOL_H
+#define DATAGRAM_POOL_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "../settings.h"
+
+static_assert(MAX_MESSAGE <= DATAGRAM_SIZE, "a publication must fit in one datagram");
+
+/* Storage for one datagram, recycled through a DatagramPool. */
+typedef struct datagram
+{
+    alignas(16) uint8_t bytes[DATAGRAM_SIZE];
+    int size;                   /* Bytes in use. */
+    struct datagram *next;      /* Free list link while the datagram is in the pool. */
+} Datagram;
+
+/*  Plaintext of a received message, decrypted in place inside its
+    datagram. Valid until the datagram is released; data is NULL when
+    nothing was received.
+*/
+typedef struct received
+{
+    const char *data;
+    int size;
+    Datagram *datagram;
+} Received;
+
+/*  Free list of datagram buffers owned by one session. Buffers are
+    allocated on first demand and reused afterwards, so receiving and
+    publishing in steady state never touch the allocator. Not thread-safe:
+    a session is served by one thread at a time.
+*/
+class DatagramPool
+{
+
+  public:
+    DatagramPool();
+    ~DatagramPool();
+
+    DatagramPool(const DatagramPool &) = delete;
+    DatagramPool &operator=(const DatagramPool &) = delete;
+
+    Datagram *acquire();
+    void release(Datagram *datagram);
+
+  private:
+    Datagram *idle = NULL;
+    std::vector<Datagram *> owned;
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "FiberUDPSocket.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+FiberUDPSocket::FiberUDPSocket(EventLoop *loop)
+    : loop(loop)
+{
+    memset(&remote, 0, sizeof(remote));
+    strncpy(server_name, "0.0.0.0", sizeof(server_name));
+    strncpy(client_name, "0.0.0.0", sizeof(client_name));
+}
+
+FiberUDPSocket::~FiberUDPSocket()
+{
+    finish();
+}
+
+/* For servers */
+int FiberUDPSocket::connect()
+{
+    finish();
+
+    fd = socket(PF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+        return DENIED;
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(DEFAULT_PORT);
+    local.sin_addr.s_addr = INADDR_ANY;
+
+    if (bind(fd, (struct sockaddr *)&local, sizeof(local)) < 0)
+        return DENIED;
+
+    connected = false;
+    return OK;
+}
+
+/* For clients */
+int FiberUDPSocket::connect(char *address, int port)
+{
+    finish();
+
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(port);
+
+    /* Resolving a name blocks the whole loop: prefer numeric addresses. */
+    if (inet_aton(address, &remote.sin_addr) == 0)
+    {
+        struct hostent *server = gethostbyname(address);
+        if (server == NULL)
+        {
+            fprintf(stderr, "ERROR, no such host\n");
+            return DENIED;
+        }
+        memcpy(&remote.sin_addr, server->h_addr, server->h_length);
+    }
+
+    fd = socket(PF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+        return DENIED;
+
+    if (::connect(fd, (struct sockaddr *)&remote, sizeof(remote)) < 0)
+    {
+        finish();
+        return DENIED;
+    }
+
+    connected = true;
+    return OK;
+}
+
+void FiberUDPSocket::max_response_time(int seconds, int microseconds)
+{
+    timeout_us = (long)seconds * 1000000 + microseconds;
+}
+
+char *FiberUDPSocket::server_address()
+{
+    strncpy(server_name, inet_ntoa(remote.sin_addr), sizeof(server_name) - 1);
+    return server_name;
+}
+
+char *FiberUDPSocket::client_address()
+{
+    struct sockaddr_in local;
+    socklen_t size = sizeof(local);
+
+    if (fd >= 0 && getsockname(fd, (struct sockaddr *)&local, &size) == 0)
+        strncpy(client_name, inet_ntoa(local.sin_addr), sizeof(client_name) - 1);
+    return client_name;
+}
+
+int FiberUDPSocket::send(const void *buffer, size_t size)
+{
+    if (connected)
+        return ::send(fd, buffer, size, 0);
+    return sendto(fd, buffer, size, 0, (struct sockaddr *)&remote, remote_size);
+}
+
+int FiberUDPSocket::sendv(const struct iovec *parts, int count)
+{
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    if (!connected)
+    {
+        message.msg_name = &remote;
+        message.msg_namelen = remote_size;
+    }
+    message.msg_iov = (struct iovec *)parts;
+    message.msg_iovlen = count;
+
+    return sendmsg(fd, &message, 0);
+}
+
+int FiberUDPSocket::recv(void *buffer, size_t size)
+{
+    const long long deadline = EventLoop::now() + timeout_us;
+
+    while (true)
+    {
+        remote_size = sizeof(remote);
+        const int received = connected ? ::recv(fd, buffer, size, 0)
+                                       : recvfrom(fd, buffer, size, 0, (struct sockaddr *)&remote, &remote_size);
+        if (received >= 0 || errno != EAGAIN)
+            return received;
+
+        long wait = 0;
+        if (timeout_us > 0)
+        {
+            wait = (long)(deadline - EventLoop::now());
+            if (wait <= 0)
+                return -1;
+        }
+
+        if (!loop->waitReadable(fd, wait))
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+}
+
+uint32_t FiberUDPSocket::peer_address()
+{
+    return ntohl(remote.sin_addr.s_addr);
+}
+
+int FiberUDPSocket::finish()
+{
+    if (fd < 0)
+        return 0;
+
+    const int result = close(fd);
+    fd = -1;
+    connected = false;
+    return result;
+}
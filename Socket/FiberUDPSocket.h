@@ -0,0 +1,48 @@
+#ifndef FIBER_UDP_SOCKET_H
+#define FIBER_UDP_SOCKET_H
+
+#include <netinet/in.h>
+
+#include "../settings.h"
+#include "../Event/EventLoop.h"
+#include "Transport.h"
+
+/*  Non-blocking UDP socket for code running inside an EventLoop fiber.
+    recv parks the fiber instead of the thread, so thousands of clients
+    can share one thread. Clients use a connected socket, which filters
+    datagrams from other peers.
+*/
+class FiberUDPSocket : public Transport
+{
+
+  public:
+    FiberUDPSocket(EventLoop *loop);
+    ~FiberUDPSocket();
+
+    /* For servers */
+    int connect() override;
+    /* For clients */
+    int connect(char *address, int port) override;
+    void max_response_time(int seconds, int microseconds) override;
+    char *server_address() override;
+    char *client_address() override;
+    int send(const void *buffer, size_t size) override;
+    int sendv(const struct iovec *parts, int count) override;
+    int recv(void *buffer, size_t size) override;
+    int finish() override;
+    uint32_t peer_address() override;
+
+  private:
+    EventLoop *loop;
+    int fd = -1;
+
+    struct sockaddr_in remote;
+    socklen_t remote_size = sizeof(struct sockaddr_in);
+    bool connected = false;
+
+    long timeout_us = 0; /* 0 waits forever, like SO_RCVTIMEO. */
+    char server_name[16];
+    char client_name[16];
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "ImpairedTransport.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../time.h"
+
+ImpairedTransport::ImpairedTransport(Transport *inner, Impairment impairment)
+    : inner(inner), impairment(impairment), rng(impairment.seed), uniform(0.0, 1.0), scratch(65536)
+{
+}
+
+/* For servers */
+int ImpairedTransport::connect()
+{
+    return inner->connect();
+}
+
+/* For clients */
+int ImpairedTransport::connect(char *address, int port)
+{
+    return inner->connect(address, port);
+}
+
+void ImpairedTransport::max_response_time(int seconds, int microseconds)
+{
+    timeout = seconds + microseconds / 1000000.0;
+    inner->max_response_time(seconds, microseconds);
+}
+
+char *ImpairedTransport::server_address()
+{
+    return inner->server_address();
+}
+
+uint32_t ImpairedTransport::peer_address()
+{
+    return inner->peer_address();
+}
+
+char *ImpairedTransport::client_address()
+{
+    return inner->client_address();
+}
+
+int ImpairedTransport::send(const void *buffer, size_t size)
+{
+    return inner->send(buffer, size);
+}
+
+int ImpairedTransport::sendv(const struct iovec *parts, int count)
+{
+    return inner->sendv(parts, count);
+}
+
+int ImpairedTransport::recv(void *buffer, size_t size)
+{
+    const double start = currentTime();
+
+    while (true)
+    {
+        if (!pending.empty())
+        {
+            Message message = pending.front();
+            pending.pop_front();
+            return deliver(message, buffer, size);
+        }
+
+        const int received = inner->recv(scratch.data(), scratch.size());
+
+        if (received <= 0)
+        {
+            /* Nothing came after a held message: release it late. */
+            if (holding)
+            {
+                holding = false;
+                return deliver(held, buffer, size);
+            }
+            return received;
+        }
+
+        const double arrival = currentTime();
+
+        if (roll(impairment.loss))
+        {
+            droppedCount++;
+
+            /* Keep the caller's timeout even when losses restart the inner wait. */
+            if (timeout > 0 && arrival - start >= timeout)
+            {
+                errno = EAGAIN;
+                return -1;
+            }
+            continue;
+        }
+
+        Message message;
+        message.data.assign(scratch.begin(), scratch.begin() + received);
+        message.deliverAt = deliveryTime(arrival);
+
+        if (roll(impairment.duplicate))
+        {
+            duplicatedCount++;
+            Message copy = message;
+            copy.deliverAt = deliveryTime(arrival);
+            pending.push_back(copy);
+        }
+
+        if (holding)
+        {
+            /* This message overtakes the held one. */
+            holding = false;
+            pending.push_back(held);
+        }
+        else if (roll(impairment.reorder))
+        {
+            reorderedCount++;
+            held = message;
+            holding = true;
+            continue;
+        }
+
+        return deliver(message, buffer, size);
+    }
+}
+
+int ImpairedTransport::finish()
+{
+    pending.clear();
+    holding = false;
+    return inner->finish();
+}
+
+unsigned long ImpairedTransport::dropped()
+{
+    return droppedCount;
+}
+
+unsigned long ImpairedTransport::duplicated()
+{
+    return duplicatedCount;
+}
+
+unsigned long ImpairedTransport::reordered()
+{
+    return reorderedCount;
+}
+
+bool ImpairedTransport::roll(double probability)
+{
+    return probability > 0 && uniform(rng) < probability;
+}
+
+double ImpairedTransport::deliveryTime(double arrival)
+{
+    const double delay = impairment.delay + impairment.jitter * uniform(rng);
+    return arrival + delay / 1000.0;
+}
+
+int ImpairedTransport::deliver(Message &message, void *buffer, size_t size)
+{
+    const double wait = message.deliverAt - currentTime();
+    if (wait > 0)
+        usleep(wait * 1000000);
+
+    const size_t copied = message.data.size() < size ? message.data.size() : size;
+    memcpy(buffer, message.data.data(), copied);
+    return copied;
+}
@@ -0,0 +1,77 @@
+#ifndef IMPAIRED_TRANSPORT_H
+#define IMPAIRED_TRANSPORT_H
+
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "../settings.h"
+#include "Transport.h"
+
+/* Network conditions applied to the messages received by an ImpairedTransport. */
+typedef struct impairment
+{
+    double delay = 0;     /* Fixed one-way delay, in ms. */
+    double jitter = 0;    /* Uniform extra delay in [0, jitter], in ms. */
+    double loss = 0;      /* Probability of dropping a message. */
+    double duplicate = 0; /* Probability of delivering a message twice. */
+    double reorder = 0;   /* Probability of holding a message back behind the next one. */
+    unsigned seed = 1;    /* Seed of the RNG, so a run can be replayed. */
+} Impairment;
+
+/*  Wraps another transport (UDPSocket, LoopbackTransport...) and impairs
+    its inbound direction. Wrap both endpoints to impair both directions.
+*/
+class ImpairedTransport : public Transport
+{
+
+  public:
+    ImpairedTransport(Transport *inner, Impairment impairment);
+
+    /* For servers */
+    int connect() override;
+    /* For clients */
+    int connect(char *address, int port) override;
+    void max_response_time(int seconds, int microseconds) override;
+    char *server_address() override;
+    char *client_address() override;
+    int send(const void *buffer, size_t size) override;
+    int sendv(const struct iovec *parts, int count) override;
+    int recv(void *buffer, size_t size) override;
+    int finish() override;
+    uint32_t peer_address() override;
+
+    unsigned long dropped();
+    unsigned long duplicated();
+    unsigned long reordered();
+
+  private:
+    typedef struct message
+    {
+        std::vector<unsigned char> data;
+        double deliverAt; /* Seconds, as returned by currentTime(). */
+    } Message;
+
+    Transport *inner;
+    Impairment impairment;
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> uniform;
+
+    std::deque<Message> pending; /* Duplicates and messages released after a reorder. */
+    Message held;
+    bool holding = false;
+
+    std::vector<unsigned char> scratch;
+    double timeout = 0; /* Seconds, 0 waits forever. */
+
+    unsigned long droppedCount = 0;
+    unsigned long duplicatedCount = 0;
+    unsigned long reorderedCount = 0;
+
+    bool roll(double probability);
+    double deliveryTime(double arrival);
+    int deliver(Message &message, void *buffer, size_t size);
+};
+
+#endif
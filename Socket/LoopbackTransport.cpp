@@ -0,0 +1,119 @@
+#include "LoopbackTransport.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <thread>
+
+#include "../time.h"
+
+LoopbackTransport::LoopbackTransport(LoopbackRing *rx, LoopbackRing *tx)
+    : rx(rx), tx(tx)
+{
+    strncpy(address, "127.0.0.1", sizeof(address));
+}
+
+/* For servers */
+int LoopbackTransport::connect()
+{
+    return OK;
+}
+
+/* For clients */
+int LoopbackTransport::connect(char * /* address */, int /* port */)
+{
+    return OK;
+}
+
+void LoopbackTransport::max_response_time(int seconds, int microseconds)
+{
+    timeout_us = (long)seconds * 1000000 + microseconds;
+}
+
+char *LoopbackTransport::server_address()
+{
+    return address;
+}
+
+uint32_t LoopbackTransport::peer_address()
+{
+    return INADDR_LOOPBACK;
+}
+
+char *LoopbackTransport::client_address()
+{
+    return address;
+}
+
+int LoopbackTransport::send(const void *buffer, size_t size)
+{
+    if (!tx->push(buffer, size))
+    {
+        errno = ENOBUFS;
+        return -1;
+    }
+    return size;
+}
+
+int LoopbackTransport::sendv(const struct iovec *parts, int count)
+{
+    const int size = tx->push(parts, count);
+    if (size < 0)
+    {
+        errno = ENOBUFS;
+        return -1;
+    }
+    return size;
+}
+
+int LoopbackTransport::recv(void *buffer, size_t size)
+{
+    int received = rx->pop(buffer, size);
+    if (received >= 0)
+        return received;
+
+    /* Spin briefly, then yield, until the peer pushes or the timeout expires. */
+    const uint64_t deadline = nanoTime() + (uint64_t)timeout_us * 1000;
+    for (unsigned spins = 0;; spins++)
+    {
+        received = rx->pop(buffer, size);
+        if (received >= 0)
+            return received;
+
+        if (spins < 64)
+            continue;
+
+        if (timeout_us > 0 && nanoTime() >= deadline)
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+        std::this_thread::yield();
+    }
+}
+
+int LoopbackTransport::finish()
+{
+    return 0;
+}
+
+LoopbackLink::LoopbackLink()
+    : toServer(new LoopbackRing()), toClient(new LoopbackRing()),
+      serverEnd(toServer, toClient), clientEnd(toClient, toServer)
+{
+}
+
+LoopbackLink::~LoopbackLink()
+{
+    delete toServer;
+    delete toClient;
+}
+
+Transport *LoopbackLink::server()
+{
+    return &serverEnd;
+}
+
+Transport *LoopbackLink::client()
+{
+    return &clientEnd;
+}
@@ -0,0 +1,65 @@
+#ifndef LOOPBACK_TRANSPORT_H
+#define LOOPBACK_TRANSPORT_H
+
+#include "../settings.h"
+#include "Transport.h"
+#include "SPSCRing.h"
+
+/* Largest handshake message (DHEncPacket) fits in one slot. */
+#define LOOPBACK_MTU 4096
+#define LOOPBACK_SLOTS 8
+
+typedef SPSCRing<LOOPBACK_SLOTS, LOOPBACK_MTU> LoopbackRing;
+
+/*  One end of an in-process link. Messages go straight from the
+    sender's buffer into the peer's ring, without any syscall.
+*/
+class LoopbackTransport : public Transport
+{
+
+  public:
+    LoopbackTransport(LoopbackRing *rx, LoopbackRing *tx);
+
+    /* For servers */
+    int connect() override;
+    /* For clients */
+    int connect(char *address, int port) override;
+    void max_response_time(int seconds, int microseconds) override;
+    char *server_address() override;
+    char *client_address() override;
+    int send(const void *buffer, size_t size) override;
+    int sendv(const struct iovec *parts, int count) override;
+    int recv(void *buffer, size_t size) override;
+    int finish() override;
+    uint32_t peer_address() override;
+
+  private:
+    LoopbackRing *rx;
+    LoopbackRing *tx;
+
+    long timeout_us = 0; /* 0 waits forever, like SO_RCVTIMEO. */
+    char address[16];
+};
+
+/*  Two LoopbackTransport endpoints connected by a pair of SPSC rings.
+    Each endpoint must be driven by a single thread.
+*/
+class LoopbackLink
+{
+
+  public:
+    LoopbackLink();
+    ~LoopbackLink();
+
+    Transport *server();
+    Transport *client();
+
+  private:
+    LoopbackRing *toServer;
+    LoopbackRing *toClient;
+
+    LoopbackTransport serverEnd;
+    LoopbackTransport clientEnd;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <atomic>
+
+/*  Lock-free single producer / single consumer ring of datagrams.
+    Each slot holds one whole message of at most SLOT_SIZE bytes.
+*/
+template <size_t SLOTS, size_t SLOT_SIZE>
+class SPSCRing
+{
+    static_assert((SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of two");
+
+  public:
+    SPSCRing() : head(0), tail(0) {}
+
+    /* Producer side. Returns false if the ring is full or the message does not fit a slot. */
+    bool push(const void *buffer, size_t size)
+    {
+        if (size > SLOT_SIZE)
+            return false;
+
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == SLOTS)
+            return false;
+
+        Slot &slot = slots[t & (SLOTS - 1)];
+        memcpy(slot.data, buffer, size);
+        slot.size = size;
+
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Producer side, gathering the parts straight into one slot.
+       Returns the size of the message, or -1 if it was not queued. */
+    int push(const struct iovec *parts, int count)
+    {
+        size_t size = 0;
+        for (int i = 0; i < count; i++)
+            size += parts[i].iov_len;
+        if (size > SLOT_SIZE)
+            return -1;
+
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == SLOTS)
+            return -1;
+
+        Slot &slot = slots[t & (SLOTS - 1)];
+        size_t offset = 0;
+        for (int i = 0; i < count; i++)
+        {
+            memcpy(slot.data + offset, parts[i].iov_base, parts[i].iov_len);
+            offset += parts[i].iov_len;
+        }
+        slot.size = size;
+
+        tail.store(t + 1, std::memory_order_release);
+        return size;
+    }
+
+    /* Consumer side. Returns the size of the message, or -1 if the ring is empty.
+       Like recvfrom, a message larger than the buffer is truncated. */
+    int pop(void *buffer, size_t size)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return -1;
+
+        const Slot &slot = slots[h & (SLOTS - 1)];
+        const size_t copied = slot.size < size ? slot.size : size;
+        memcpy(buffer, slot.data, copied);
+
+        head.store(h + 1, std::memory_order_release);
+        return copied;
+    }
+
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+  private:
+    struct Slot
+    {
+        size_t size;
+        unsigned char data[SLOT_SIZE];
+    };
+
+    /* Head and tail live on separate cache lines so producer and consumer do not share one. */
+    std::atomic<size_t> head; /* Next slot to read, owned by the consumer. */
+    char padHead[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail; /* Next slot to write, owned by the producer. */
+    char padTail[64 - sizeof(std::atomic<size_t>)];
+    Slot slots[SLOTS];
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <vector>
+
+/*  Datagram transport used by AuthServer and AuthClient.
+    Implementations keep the recvfrom/sendto semantics of UDPSocket:
+    one call moves one whole message, recv returns <= 0 on timeout.
+*/
+class Transport
+{
+
+  public:
+    virtual ~Transport() {}
+
+    /* For servers */
+    virtual int connect() = 0;
+    /* For clients */
+    virtual int connect(char *address, int port) = 0;
+    virtual void max_response_time(int seconds, int microseconds) = 0;
+    virtual char *server_address() = 0;
+    virtual char *client_address() = 0;
+    virtual int send(const void *buffer, size_t size) = 0;
+
+    /*  Sends the parts as one datagram, without joining them first.
+        The default joins them and calls send(); transports override it
+        with sendmsg() or an equivalent that writes the parts directly.
+    */
+    virtual int sendv(const struct iovec *parts, int count)
+    {
+        std::vector<unsigned char> joined;
+        for (int i = 0; i < count; i++)
+            joined.insert(joined.end(), (unsigned char *)parts[i].iov_base, (unsigned char *)parts[i].iov_base + parts[i].iov_len);
+        return send(joined.data(), joined.size());
+    }
+    virtual int recv(void *buffer, size_t size) = 0;
+    virtual int finish() = 0;
+
+    /* IPv4 address of the last peer heard from, in host byte order; 0 if unknown. */
+    virtual uint32_t peer_address() { return 0; }
+};
+
+#endif
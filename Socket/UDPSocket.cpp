@@ -75,11 +75,28 @@ int UDPSocket::send(const void *buffer, size_t size)
     return sendto(soc.socket, buffer, size, 0, soc.remote, soc.size);
 }
 
+int UDPSocket::sendv(const struct iovec *parts, int count)
+{
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_name = soc.remote;
+    message.msg_namelen = soc.size;
+    message.msg_iov = (struct iovec *)parts;
+    message.msg_iovlen = count;
+
+    return sendmsg(soc.socket, &message, 0);
+}
+
 int UDPSocket::recv(void *buffer, size_t size)
 {
     return recvfrom(soc.socket, buffer, size, 0, soc.remote, &soc.size);
 }
 
+uint32_t UDPSocket::peer_address()
+{
+    return ntohl(((struct sockaddr_in *)soc.remote)->sin_addr.s_addr);
+}
+
 int UDPSocket::finish()
 {
     return close(soc.socket);
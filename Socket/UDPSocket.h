@@ -10,6 +10,7 @@
 #include <strings.h>
 
 #include "../settings.h"
+#include "Transport.h"
 
 typedef struct Socket
 {
@@ -18,20 +19,22 @@ typedef struct Socket
     socklen_t size;
 } t_socket;
 
-class UDPSocket
+class UDPSocket : public Transport
 {
 
   public:
     /* For servers */
-    int connect();
+    int connect() override;
     /* For clients */
-    int connect(char *address, int port);
-    void max_response_time(int seconds, int milliseconds);
-    char *server_address();
-    char *client_address();
-    int send(const void *buffer, size_t size);
-    int recv(void *buffer, size_t size);
-    int finish();
+    int connect(char *address, int port) override;
+    void max_response_time(int seconds, int milliseconds) override;
+    char *server_address() override;
+    char *client_address() override;
+    int send(const void *buffer, size_t size) override;
+    int sendv(const struct iovec *parts, int count) override;
+    int recv(void *buffer, size_t size) override;
+    int finish() override;
+    uint32_t peer_address() override;
 
   private:
     Socket soc;
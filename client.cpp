@@ -7,6 +7,10 @@ AuthClient auth;
 
 int main(int argc, char *argv[])
 {
+    /* Grava o trace binário dos handshakes quando TRACE_FILE estiver definido. */
+    if (getenv("TRACE_FILE"))
+        trace::start(getenv("TRACE_FILE"));
+
     double start = currentTime();
 
     auth.connect(argv[1]);
@@ -23,4 +27,6 @@ int main(int argc, char *argv[])
 
     double end = currentTime();
     cout << "Elapsed Time: " << elapsedTime(start, end) << " ms." << endl;
+
+    trace::stop();
 }
@@ -1 +1 @@
-g++ -std=c++17 $1 -p -o client client.cpp RSA/RSA.cpp RSA/RSAPackage.cpp AES/AES.cpp fdr.cpp utils.cpp Auth/iotAuth.cpp Auth/AuthClient.cpp SHA/sha512.cpp RSA/RSAKeyExchange.cpp  Diffie-Hellman/DiffieHellmanPackage.cpp Diffie-Hellman/DHEncPacket.cpp Diffie-Hellman/DHKeyExchange.cpp RSA/RSAStorage.cpp Diffie-Hellman/DHStorage.cpp time.cpp verbose/verbose_client.cpp Socket/UDPSocket.cpp
+g++ -std=c++14 $1 -pthread -p -o client client.cpp RSA/RSA.cpp RSA/RSAPackage.cpp AES/AES.cpp fdr.cpp utils.cpp random.cpp Auth/iotAuth.cpp Auth/Arena.cpp Event/WorkerPool.cpp Event/SessionScheduler.cpp Event/EventLoop.cpp Event/Fiber.cpp Auth/AuthClient.cpp Auth/SessionTicket.cpp SHA/sha512.cpp RSA/RSAKeyExchange.cpp  Diffie-Hellman/DiffieHellmanPackage.cpp Diffie-Hellman/DHEncPacket.cpp Diffie-Hellman/DHKeyExchange.cpp RSA/RSAStorage.cpp Diffie-Hellman/DHStorage.cpp time.cpp verbose/verbose_client.cpp Socket/UDPSocket.cpp Socket/DatagramPool.cpp trace/trace.cpp
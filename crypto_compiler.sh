@@ -0,0 +1 @@
+g++ -std=c++14 -DUSE_TSC=true -O2 -DVERBOSE=false $1 -pthread -o crypto Benchmark/crypto.cpp RSA/RSA.cpp AES/AES.cpp SHA/sha512.cpp fdr.cpp utils.cpp random.cpp time.cpp Auth/iotAuth.cpp Auth/Arena.cpp Event/WorkerPool.cpp Event/SessionScheduler.cpp Event/EventLoop.cpp Event/Fiber.cpp Diffie-Hellman/DHStorage.cpp
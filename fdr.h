@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "wire.h"
+
 class FDR
 {
   public:
@@ -18,6 +20,9 @@ class FDR
   private:
     char operating = '+';
     int operand = 0;
+
+  public:
+    typedef wire::Fields<WIRE_FIELD(FDR, operating), WIRE_FIELD(FDR, operand)> Wire;
 };
 
 #endif
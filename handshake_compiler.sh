@@ -0,0 +1 @@
+g++ -std=c++14 -DUSE_TSC=true -O2 -DVERBOSE=false -DADMISSION=false -DCRYPTO_WORKERS=0 -DTIMEOUT_SEC=0 -DTIMEOUT_MIC=200000 $1 -pthread -o handshake Benchmark/handshake.cpp Benchmark/harness.cpp RSA/RSA.cpp AES/AES.cpp fdr.cpp utils.cpp random.cpp Auth/iotAuth.cpp Auth/Arena.cpp Event/WorkerPool.cpp Event/SessionScheduler.cpp Event/EventLoop.cpp Event/Fiber.cpp SHA/sha512.cpp RSA/RSAKeyExchange.cpp Diffie-Hellman/DiffieHellmanPackage.cpp Diffie-Hellman/DHKeyExchange.cpp Diffie-Hellman/DHStorage.cpp Diffie-Hellman/DHEncPacket.cpp RSA/RSAStorage.cpp RSA/RSAPackage.cpp time.cpp verbose/verbose_server.cpp verbose/verbose_client.cpp Auth/AuthServer.cpp Auth/TimeLimits.cpp Auth/SessionTicket.cpp Auth/SessionCache.cpp Auth/SynCookie.cpp Auth/Admission.cpp Auth/AuthClient.cpp Socket/UDPSocket.cpp Socket/DatagramPool.cpp Socket/LoopbackTransport.cpp trace/trace.cpp metrics/metrics.cpp metrics/histogram.cpp
@@ -0,0 +1,114 @@
+#include "histogram.h"
+
+Histogram::Histogram()
+{
+    reset();
+}
+
+int Histogram::index(uint64_t ns)
+{
+    const uint64_t limit = (2ull << MAX_EXP) - 1;
+    if (ns > limit)
+        ns = limit;
+
+    /* Valores pequenos têm bucket exato. */
+    if (ns < 2 * SUB)
+        return (int)ns;
+
+    const int exponent = 63 - __builtin_clzll(ns);
+    const int shift = exponent - SUB_BITS;
+    return shift * SUB + (int)(ns >> shift);
+}
+
+uint64_t Histogram::lowerBound(int index)
+{
+    if (index < 2 * SUB)
+        return index;
+
+    const int shift = index / SUB - 1;
+    return (uint64_t)(index - shift * SUB) << shift;
+}
+
+void Histogram::record(uint64_t ns)
+{
+    counts[index(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t current = maximum.load(std::memory_order_relaxed);
+    while (ns > current && !maximum.compare_exchange_weak(current, ns, std::memory_order_relaxed));
+}
+
+void Histogram::recordMs(double ms)
+{
+    record(ms > 0 ? (uint64_t)(ms * 1000000.0) : 0);
+}
+
+uint64_t Histogram::count() const
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+double Histogram::mean() const
+{
+    const uint64_t n = count();
+    return n ? sum.load(std::memory_order_relaxed) / (double)n / 1000000.0 : 0;
+}
+
+double Histogram::max() const
+{
+    return maximum.load(std::memory_order_relaxed) / 1000000.0;
+}
+
+double Histogram::quantile(double q) const
+{
+    const Histogram *self = this;
+    const double value = quantile(&self, 1, q);
+    return value < max() ? value : max();
+}
+
+double Histogram::quantile(const Histogram *const *histograms, int count, double q)
+{
+    /* Soma dos buckets em vez de 'total': os dois podem divergir durante um record(). */
+    uint64_t n = 0;
+    for (int h = 0; h < count; h++)
+        for (int i = 0; i < BUCKETS; i++)
+            n += histograms[h]->bucket(i);
+    if (n == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t)(q * n);
+    if (rank >= n)
+        rank = n - 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        for (int h = 0; h < count; h++)
+            seen += histograms[h]->bucket(i);
+        if (seen > rank)
+            return bucketValue(i);
+    }
+    return bucketValue(BUCKETS - 1);
+}
+
+uint64_t Histogram::bucket(int index) const
+{
+    return counts[index].load(std::memory_order_relaxed);
+}
+
+double Histogram::bucketValue(int index)
+{
+    const uint64_t low = lowerBound(index);
+    const uint64_t high = index + 1 < BUCKETS ? lowerBound(index + 1) : low + 1;
+    return (low + (high - low) / 2.0) / 1000000.0;
+}
+
+void Histogram::reset()
+{
+    for (int i = 0; i < BUCKETS; i++)
+        counts[i].store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,51 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <atomic>
+
+/*  Histograma de latências no estilo HDR.
+    Valores em nanossegundos, de 1 ns a ~137 s, com erro relativo abaixo
+    de 1% (128 sub-buckets por potência de 2). record() usa apenas
+    incrementos atômicos relaxados e pode ser chamado por várias threads.
+*/
+class Histogram
+{
+  public:
+    static const int SUB_BITS = 7;
+    static const int SUB = 1 << SUB_BITS;
+    static const int MAX_EXP = 36;
+    static const int BUCKETS = SUB * (MAX_EXP - SUB_BITS + 2);
+
+    Histogram();
+
+    void record(uint64_t ns);
+    /* Conveniência para os tempos em ms calculados pelo AuthServer. */
+    void recordMs(double ms);
+
+    uint64_t count() const;
+    double mean() const;      /* Em ms. */
+    double max() const;       /* Em ms. */
+    /* Valor no quantil dado (0..1), em ms. */
+    double quantile(double q) const;
+
+    void reset();
+
+    /*  Acesso aos buckets, para combinar histogramas (ver quantile abaixo). */
+    uint64_t bucket(int index) const;
+    static double bucketValue(int index); /* Ponto médio do bucket, em ms. */
+
+    /* Quantil da soma de vários histogramas, em ms. */
+    static double quantile(const Histogram *const *histograms, int count, double q);
+
+  private:
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> maximum;
+
+    static int index(uint64_t ns);
+    static uint64_t lowerBound(int index);
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../time.h"
+
+namespace metrics
+{
+
+const char *timerName[TIMERS] = {"network_time", "processing_time1", "processing_time2", "auxiliar_time",
+                                 "total_time_rsa", "total_time_dh", "handshake_time", "resume_time"};
+
+const char *statusName[METRICS_STATUSES] = {"OK", "DENIED", "TIMEOUT", "NO_REPLY", "NONCE_INVALID",
+                                            "FDR_INVALID", "HASH_INVALID", "FINISHED", "NOT_CONNECTED"};
+
+const char *shedName[SHED_REASONS] = {"rate", "busy", "stray"};
+
+static Histogram timers[TIMERS];
+static std::atomic<uint64_t> statuses[METRICS_STATUSES];
+static std::atomic<uint64_t> shedding[SHED_REASONS];
+
+static const uint64_t origin = nanoTime();
+
+static std::string dumpPath;
+static int dumpInterval;
+static std::thread dumper;
+static std::mutex dumpLock;
+static std::condition_variable dumpWake;
+static bool dumping = false;
+
+Histogram &histogram(int timer)
+{
+    return timers[timer];
+}
+
+void record(int timer, double ms)
+{
+    timers[timer].recordMs(ms);
+}
+
+void count(int status)
+{
+    if (status >= 0 && status < METRICS_STATUSES)
+        statuses[status].fetch_add(1, std::memory_order_relaxed);
+}
+
+void shed(int reason)
+{
+    if (reason >= 0 && reason < SHED_REASONS)
+        shedding[reason].fetch_add(1, std::memory_order_relaxed);
+}
+
+Snapshot snapshot()
+{
+    Snapshot s;
+    s.uptime = (nanoTime() - origin) / 1000000000.0;
+
+    for (int t = 0; t < TIMERS; t++)
+    {
+        Histogram &h = timers[t];
+        s.timers[t].count = h.count();
+        s.timers[t].mean = h.mean();
+        s.timers[t].p50 = h.quantile(0.5);
+        s.timers[t].p90 = h.quantile(0.9);
+        s.timers[t].p99 = h.quantile(0.99);
+        s.timers[t].p999 = h.quantile(0.999);
+        s.timers[t].max = h.max();
+    }
+
+    for (int i = 0; i < METRICS_STATUSES; i++)
+        s.statuses[i] = statuses[i].load(std::memory_order_relaxed);
+    for (int i = 0; i < SHED_REASONS; i++)
+        s.shed[i] = shedding[i].load(std::memory_order_relaxed);
+
+    return s;
+}
+
+void write(FILE *out, const Snapshot &s)
+{
+    fprintf(out, "{\n  \"uptime_s\": %.3f,\n  \"latency_ms\": {\n", s.uptime);
+    for (int t = 0; t < TIMERS; t++)
+    {
+        const Summary &m = s.timers[t];
+        fprintf(out, "    \"%s\": {\"count\": %llu, \"mean\": %.6f, \"p50\": %.6f, \"p90\": %.6f, "
+                     "\"p99\": %.6f, \"p999\": %.6f, \"max\": %.6f}%s\n",
+                timerName[t], (unsigned long long)m.count, m.mean, m.p50, m.p90, m.p99, m.p999, m.max,
+                t + 1 < TIMERS ? "," : "");
+    }
+    fprintf(out, "  },\n  \"handshakes\": {");
+    for (int i = 0; i < METRICS_STATUSES; i++)
+        fprintf(out, "%s\"%s\": %llu", i ? ", " : "", statusName[i], (unsigned long long)s.statuses[i]);
+    fprintf(out, "},\n  \"shed\": {");
+    for (int i = 0; i < SHED_REASONS; i++)
+        fprintf(out, "%s\"%s\": %llu", i ? ", " : "", shedName[i], (unsigned long long)s.shed[i]);
+    fprintf(out, "}\n}\n");
+}
+
+/* Grava em um arquivo temporário e renomeia, para que leitores nunca vejam um arquivo pela metade. */
+static void dump()
+{
+    const std::string temporary = dumpPath + ".tmp";
+
+    FILE *out = fopen(temporary.c_str(), "w");
+    if (out == NULL)
+        return;
+
+    write(out, snapshot());
+    fclose(out);
+    rename(temporary.c_str(), dumpPath.c_str());
+}
+
+static void dumpLoop()
+{
+    std::unique_lock<std::mutex> lock(dumpLock);
+    while (dumping)
+    {
+        dumpWake.wait_for(lock, std::chrono::milliseconds(dumpInterval));
+        dump();
+    }
+}
+
+bool startDump(const char *path, int interval)
+{
+    std::lock_guard<std::mutex> lock(dumpLock);
+    if (dumping)
+        return false;
+
+    dumpPath = path;
+    dumpInterval = interval > 0 ? interval : 1000;
+    dumping = true;
+    dumper = std::thread(dumpLoop);
+    return true;
+}
+
+void stopDump()
+{
+    {
+        std::lock_guard<std::mutex> lock(dumpLock);
+        if (!dumping)
+            return;
+        dumping = false;
+    }
+    dumpWake.notify_all();
+    dumper.join();
+}
+
+void reset()
+{
+    for (int t = 0; t < TIMERS; t++)
+        timers[t].reset();
+    for (int i = 0; i < METRICS_STATUSES; i++)
+        statuses[i].store(0, std::memory_order_relaxed);
+    for (int i = 0; i < SHED_REASONS; i++)
+        shedding[i].store(0, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "histogram.h"
+#include "../settings.h"
+
+/*  Métricas do handshake do Servidor.
+    Os tempos medidos em cada prova de tempo vão para histogramas e cada
+    resultado de handshake é contado por status. Tudo é global ao processo
+    e sem locks; snapshot() e o dump periódico leem os valores correntes.
+*/
+namespace metrics
+{
+
+enum
+{
+    NETWORK_TIME,       /* Step 3, já descontado o tempo auxiliar.      */
+    PROCESSING_TIME1,   /* Step 4, enviado ao Cliente no RSA.           */
+    PROCESSING_TIME2,   /* Step 6, enviado ao Cliente no DH.            */
+    AUXILIAR_TIME,      /* Step 4.                                      */
+    TOTAL_TIME_RSA,     /* Prova de tempo do Step 5.                    */
+    TOTAL_TIME_DH,      /* Prova de tempo do Step 7.                    */
+    HANDSHAKE_TIME,     /* Do SYN recebido ao DH-ACK enviado.           */
+    RESUME_TIME,        /* Do SYN com ticket à resposta da retomada.    */
+    TIMERS
+};
+
+#define METRICS_STATUSES (NOT_CONNECTED + 1)
+
+/* Motivos de descarte do controle de admissão (Auth/Admission) e da espera pelo SYN. */
+enum
+{
+    SHED_RATE,          /* Balde do endereço de origem vazio.           */
+    SHED_BUSY,          /* Limite de handshakes simultâneos atingido.   */
+    SHED_STRAY,         /* Nem SYN nem RSA: publicação atrasada, lixo.  */
+    SHED_REASONS
+};
+
+extern const char *timerName[TIMERS];
+extern const char *statusName[METRICS_STATUSES];
+extern const char *shedName[SHED_REASONS];
+
+typedef struct summary
+{
+    uint64_t count;
+    double mean, p50, p90, p99, p999, max; /* Em ms. */
+} Summary;
+
+typedef struct snapshot
+{
+    double uptime;      /* Segundos desde o início do processo. */
+    Summary timers[TIMERS];
+    uint64_t statuses[METRICS_STATUSES];
+    uint64_t shed[SHED_REASONS];
+} Snapshot;
+
+/* Histograma de um dos tempos acima. */
+Histogram &histogram(int timer);
+
+void record(int timer, double ms);
+
+/* Conta o resultado de um handshake. */
+void count(int status);
+
+/* Conta um datagrama descartado pela admissão. */
+void shed(int reason);
+
+Snapshot snapshot();
+
+/* Escreve o snapshot em JSON. */
+void write(FILE *out, const Snapshot &snapshot);
+
+/*  Reescreve 'path' com um snapshot a cada 'interval' ms, em uma thread
+    própria. Retorna false se já houver um dump em andamento.
+*/
+bool startDump(const char *path, int interval);
+
+/* Para o dump, gravando um último snapshot. */
+void stopDump();
+
+void reset();
+
+}
+
+#endif
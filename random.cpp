@@ -0,0 +1,186 @@
+#include "random.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+
+namespace csprng
+{
+
+/* Blocos de 64 bytes gerados por lote; os 32 primeiros viram a próxima chave. */
+#define BLOCKS 8
+#define KEY_SIZE 32
+
+typedef struct state
+{
+    uint32_t key[8];
+    uint64_t counter;
+    uint8_t batch[BLOCKS * 64];
+    size_t used;            /* Bytes do lote já entregues. */
+    bool seeded;
+} State;
+
+static thread_local State state;
+
+static inline uint32_t rotl(uint32_t v, int n)
+{
+    return v << n | v >> (32 - n);
+}
+
+#define QUARTER_ROUND(a, b, c, d)  \
+    a += b; d = rotl(d ^ a, 16);   \
+    c += d; b = rotl(b ^ c, 12);   \
+    a += b; d = rotl(d ^ a, 8);    \
+    c += d; b = rotl(b ^ c, 7);
+
+static inline uint32_t load32(const uint8_t *in)
+{
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+static inline void store32(uint8_t *out, uint32_t v)
+{
+    out[0] = v;
+    out[1] = v >> 8;
+    out[2] = v >> 16;
+    out[3] = v >> 24;
+}
+
+/*  Bloco do ChaCha20 (RFC 8439) com nonce zero: cada chave é usada uma única
+    vez, então o contador de 64 bits basta para distinguir os blocos.
+*/
+static void block(const uint32_t key[8], uint64_t counter, uint8_t out[64])
+{
+    uint32_t input[16] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+        key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+        (uint32_t)counter, (uint32_t)(counter >> 32), 0, 0
+    };
+
+    uint32_t x[16];
+    memcpy(x, input, sizeof(x));
+
+    for (int i = 0; i < 10; i++)
+    {
+        QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+
+    for (int i = 0; i < 16; i++)
+        store32(out + 4 * i, x[i] + input[i]);
+}
+
+/*  Semente de 256 bits do kernel. Sem ela não há como gerar chaves seguras,
+    então o processo é encerrado.
+*/
+static void seed(State &s)
+{
+    uint8_t bytes[KEY_SIZE];
+    size_t got = 0;
+
+    while (got < sizeof(bytes))
+    {
+        ssize_t n = getrandom(bytes + got, sizeof(bytes) - got, 0);
+        if (n > 0)
+            got += n;
+        else if (n < 0 && errno != EINTR)
+            break;
+    }
+
+    if (got < sizeof(bytes))
+    {
+        FILE *in = fopen("/dev/urandom", "rb");
+        if (in != NULL)
+        {
+            got += fread(bytes + got, 1, sizeof(bytes) - got, in);
+            fclose(in);
+        }
+    }
+
+    if (got < sizeof(bytes))
+    {
+        perror("csprng: sem fonte de entropia");
+        abort();
+    }
+
+    for (int i = 0; i < 8; i++)
+        s.key[i] = load32(bytes + 4 * i);
+    memset(bytes, 0, sizeof(bytes));
+
+    s.counter = 0;
+    s.used = sizeof(s.batch);
+    s.seeded = true;
+}
+
+/*  Gera um lote novo e troca a chave pelos seus primeiros KEY_SIZE bytes,
+    que nunca são entregues.
+*/
+static void refill(State &s)
+{
+    for (int i = 0; i < BLOCKS; i++)
+        block(s.key, s.counter++, s.batch + 64 * i);
+
+    for (int i = 0; i < 8; i++)
+        s.key[i] = load32(s.batch + 4 * i);
+    memset(s.batch, 0, KEY_SIZE);
+
+    s.used = KEY_SIZE;
+}
+
+void fill(void *buffer, size_t size)
+{
+    State &s = state;
+    if (!s.seeded)
+        seed(s);
+
+    uint8_t *out = (uint8_t *)buffer;
+    while (size > 0)
+    {
+        if (s.used == sizeof(s.batch))
+            refill(s);
+
+        size_t n = sizeof(s.batch) - s.used;
+        if (n > size)
+            n = size;
+
+        /* Os bytes entregues são apagados do lote. */
+        memcpy(out, s.batch + s.used, n);
+        memset(s.batch + s.used, 0, n);
+        s.used += n;
+        out += n;
+        size -= n;
+    }
+}
+
+/*  Multiplicação de Lemire: o produto de 64 bits leva o valor sorteado para
+    [0, bound) e a rejeição da faixa baixa elimina o viés.
+*/
+uint32_t uniform(uint32_t bound)
+{
+    uint32_t x;
+    fill(&x, sizeof(x));
+
+    uint64_t m = (uint64_t)x * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound)
+    {
+        const uint32_t threshold = -bound % bound;
+        while (low < threshold)
+        {
+            fill(&x, sizeof(x));
+            m = (uint64_t)x * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+}
@@ -0,0 +1,27 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*  Gerador de números aleatórios criptograficamente seguro.
+    Cada thread tem o seu próprio ChaCha20, semeado com getrandom() no
+    primeiro uso: nada é compartilhado entre threads, então não há lock.
+    A saída é gerada em lotes de blocos; a cada lote a chave é trocada pelos
+    primeiros bytes gerados, de modo que um estado vazado não revela os
+    números já entregues.
+*/
+namespace csprng
+{
+
+/*  Preenche 'size' bytes de 'buffer' com bytes aleatórios. */
+void fill(void *buffer, size_t size);
+
+/*  Inteiro uniforme em [0, bound), sem o viés de rand() % bound.
+    'bound' deve ser maior que zero.
+*/
+uint32_t uniform(uint32_t bound);
+
+}
+
+#endif
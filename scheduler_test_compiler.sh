@@ -0,0 +1 @@
+g++ -std=c++14 -O2 $1 -pthread -o scheduler_test Event/scheduler_test.cpp Event/SessionScheduler.cpp Event/WorkerPool.cpp Event/EventLoop.cpp Event/Fiber.cpp time.cpp
@@ -9,6 +9,18 @@ int main(int argc, char *argv[])
 {
     char data[] = "hello";
 
+    /* Grava o trace binário dos handshakes quando TRACE_FILE estiver definido. */
+    if (getenv("TRACE_FILE"))
+        trace::start(getenv("TRACE_FILE"));
+
+    /* Grava os histogramas do handshake a cada segundo quando METRICS_FILE estiver definido. */
+    if (getenv("METRICS_FILE"))
+        metrics::startDump(getenv("METRICS_FILE"), 1000);
+
+    /* Mantém as sessões retomáveis em SESSION_CACHE, para sobreviverem a um reinício. */
+    if (getenv("SESSION_CACHE"))
+        sessions::open(getenv("SESSION_CACHE"));
+
     auth.wait_connection();
     
     if (auth.isConnected())
@@ -27,4 +39,9 @@ int main(int argc, char *argv[])
         
         auth.disconnect();
     }
+
+    SessionScheduler::stop();
+    sessions::close();
+    metrics::stopDump();
+    trace::stop();
 }
\ No newline at end of file
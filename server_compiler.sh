@@ -1 +1 @@
-g++ -std=c++17 $1 -o server server.cpp RSA/RSA.cpp AES/AES.cpp fdr.cpp utils.cpp Auth/iotAuth.cpp SHA/sha512.cpp RSA/RSAKeyExchange.cpp Diffie-Hellman/DiffieHellmanPackage.cpp Diffie-Hellman/DHKeyExchange.cpp Diffie-Hellman/DHStorage.cpp Diffie-Hellman/DHEncPacket.cpp RSA/RSAStorage.cpp RSA/RSAPackage.cpp time.cpp verbose/verbose_server.cpp Auth/AuthServer.cpp Socket/UDPSocket.cpp
\ No newline at end of file
+g++ -std=c++14 $1 -pthread -o server server.cpp RSA/RSA.cpp AES/AES.cpp fdr.cpp utils.cpp random.cpp Auth/iotAuth.cpp Auth/Arena.cpp Event/WorkerPool.cpp Event/SessionScheduler.cpp Event/EventLoop.cpp Event/Fiber.cpp SHA/sha512.cpp RSA/RSAKeyExchange.cpp Diffie-Hellman/DiffieHellmanPackage.cpp Diffie-Hellman/DHKeyExchange.cpp Diffie-Hellman/DHStorage.cpp Diffie-Hellman/DHEncPacket.cpp RSA/RSAStorage.cpp RSA/RSAPackage.cpp time.cpp verbose/verbose_server.cpp Auth/AuthServer.cpp Auth/TimeLimits.cpp Auth/SessionTicket.cpp Auth/SessionCache.cpp Auth/SynCookie.cpp Auth/Admission.cpp Socket/UDPSocket.cpp Socket/DatagramPool.cpp trace/trace.cpp metrics/metrics.cpp metrics/histogram.cpp
\ No newline at end of file
@@ -1,18 +1,117 @@
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
-#include "fdr.h"
+#include <stdint.h>
+#include <string.h>
 
-#define MEM_TEST false
+#include "fdr.h"
+#include "wire.h"
 
+/* Os valores abaixo podem ser redefinidos na compilação (ex.: -DVERBOSE=false). */
+#ifndef COUNT
 #define COUNT 3 /* Limite de tempo que irá esperar pelo ACK */
+#endif
 
 /* Definição de alguns atributos utilizados na comunicação */
-#define VERBOSE true
+#ifndef VERBOSE
+#define VERBOSE false   /* Saída detalhada de cada Step no console (bloqueante). */
+#endif
+#ifndef TRACE
+#define TRACE true      /* Eventos binários (trace/), ativados em tempo de execução por trace::start(). */
+#endif
+#ifndef METRICS
+#define METRICS true    /* Histogramas dos tempos do handshake do Servidor (metrics/). */
+#endif
+#ifndef TICKETS
+#define TICKETS true    /* Retomada de sessão com tickets (Auth/SessionTicket). */
+#endif
+#ifndef CRYPTO_WORKERS
+#define CRYPTO_WORKERS 0    /* Threads do RSA do Servidor (Event/SessionScheduler); 0 o faz na thread do Servidor, que de todo modo espera por ele. */
+#endif
 #define DEFAULT_PORT 8080
 
+/* Segundos de uso de cada chave de tickets do Servidor; um ticket vale por até duas rotações. */
+#ifndef TICKET_ROTATION
+#define TICKET_ROTATION 3600
+#endif
+
+/* Controle de admissão (Auth/Admission): fichas por endereço e handshakes simultâneos. */
+#ifndef ADMISSION
+#define ADMISSION true
+#endif
+#ifndef ADMISSION_RATE
+#define ADMISSION_RATE 10       /* Fichas por segundo; um handshake completo gasta duas (SYN e RSA). */
+#endif
+#ifndef ADMISSION_BURST
+#define ADMISSION_BURST 20
+#endif
+#ifndef ADMISSION_SOURCES
+#define ADMISSION_SOURCES 4096  /* Endereços acompanhados; os mais ociosos dão lugar aos novos. */
+#endif
+#ifndef ADMISSION_HANDSHAKES
+#define ADMISSION_HANDSHAKES 64 /* Handshakes após o Step 3 ao mesmo tempo, no processo todo. */
+#endif
+
+/* Segundos em que o cookie do ACK (Auth/SynCookie) é aceito no RSA do Cliente. */
+#ifndef COOKIE_LIFETIME
+#define COOKIE_LIFETIME 10
+#endif
+
+/* Cache persistente de sessões (Auth/SessionCache): slots (potência de 2) e sondagens por busca. */
+#ifndef SESSION_SLOTS
+#define SESSION_SLOTS 65536
+#endif
+#ifndef SESSION_PROBES
+#define SESSION_PROBES 16
+#endif
+
+/* Bits da chave AES das mensagens publicadas (128, 192 ou 256); Cliente e Servidor precisam concordar. */
+#ifndef AES_KEY_BITS
+#define AES_KEY_BITS 128
+#endif
+
+/* Bytes do primeiro bloco da arena de cada sessão (Auth/Arena); um handshake completo usa cerca de 11 KB. */
+#ifndef ARENA_SIZE
+#define ARENA_SIZE 12288
+#endif
+
+/* Limites das provas de tempo, aprendidos por segmento de rede (Auth/TimeLimits). */
+#ifndef LIMIT_QUANTILE
+#define LIMIT_QUANTILE 0.99     /* Quantil das latências observadas usado como base do limite. */
+#endif
+#ifndef LIMIT_MARGIN
+#define LIMIT_MARGIN 0.5        /* Folga sobre o quantil (0.5 = +50%). */
+#endif
+#ifndef LIMIT_MIN_SAMPLES
+#define LIMIT_MIN_SAMPLES 32    /* Amostras necessárias antes de abandonar os limites fixos. */
+#endif
+#ifndef LIMIT_WINDOW
+#define LIMIT_WINDOW 4096       /* Amostras por janela; o quantil considera as duas últimas. */
+#endif
+#ifndef LIMIT_GROWTH
+#define LIMIT_GROWTH 0.1        /* Quanto uma amostra pode superar o quantil atual (0.1 = +10%). */
+#endif
+#ifndef LIMIT_FLOOR_MS
+#define LIMIT_FLOOR_MS 10       /* Nenhum limite aprendido fica abaixo disto. */
+#endif
+#ifndef LIMIT_CEILING_MS
+#define LIMIT_CEILING_MS 4000   /* Nem acima disto (o antigo limite fixo do DH). */
+#endif
+#ifndef SEGMENT_PREFIX
+#define SEGMENT_PREFIX 24       /* Bits do IPv4 que identificam um segmento de rede. */
+#endif
+
 #define DONE_MESSAGE "DONE"
 
+/* Tamanho máximo dos dados de uma publicação e da mensagem cifrada (hex) que a transporta. */
+#define MAX_PAYLOAD 666
+#define MAX_MESSAGE (2 * ((MAX_PAYLOAD + 15) / 16 * 16) + 1)
+
+/* Buffer de um datagrama (Socket/DatagramPool): a MTU Ethernet, que comporta MAX_MESSAGE. */
+#ifndef DATAGRAM_SIZE
+#define DATAGRAM_SIZE 1500
+#endif
+
 #define DONE_ACK "!"
 #define DONE_ACK_CHAR '!'
 
@@ -21,26 +120,100 @@
 #define SYN false
 
 /* Maximum time wait for response */
+#ifndef TIMEOUT_SEC
 #define TIMEOUT_SEC 5
+#endif
+#ifndef TIMEOUT_MIC
 #define TIMEOUT_MIC 0
+#endif
+
+/* Bytes de cada nonce do handshake. */
+#define NONCE_SIZE 32
+
+/*  Nonce do handshake: NONCE_SIZE bytes sorteados pelo gerador da thread
+    (csprng), ou o cookie do Servidor no nonce B do ACK. Comparado byte a
+    byte, sem passar por texto.
+*/
+typedef struct handshake_nonce
+{
+    uint8_t bytes[NONCE_SIZE];
+
+    bool operator==(const handshake_nonce &other) const { return memcmp(bytes, other.bytes, NONCE_SIZE) == 0; }
+    bool operator!=(const handshake_nonce &other) const { return !(*this == other); }
+
+    typedef wire::Fields<WIRE_FIELD(handshake_nonce, bytes)> Wire;
+} Nonce;
 
 typedef struct syn
 {
     bool message = SYN;
-    char nonce[129];    /* HASH(time | idDestino | idOrigem | seq) */
+    Nonce nonce;
+
+    typedef wire::Fields<WIRE_FIELD(syn, message), WIRE_FIELD(syn, nonce)> Wire;
 } structSyn;
 
 typedef struct ack
 {
     bool message = ACK;
-    char nonceA[129];
-    char nonceB[129];
+    Nonce nonceA;
+    Nonce nonceB;
+
+    typedef wire::Fields<WIRE_FIELD(ack, message), WIRE_FIELD(ack, nonceA), WIRE_FIELD(ack, nonceB)> Wire;
 } structAck;
 
+/* Bytes da prova de posse da chave de sessão na retomada (SHA-512 truncado). */
+#define PROOF_SIZE 32
+
+/*  Ticket de sessão, opaco para o Cliente.
+    Guarda a chave de sessão e o IV cifrados com uma chave do Servidor.
+*/
+typedef struct session_ticket
+{
+    uint32_t keyId = 0;     /* Chave do Servidor que selou o ticket; 0 indica ausência. */
+    uint8_t iv[16];
+    uint8_t sealed[16];     /* AES(chave de sessão | IV | aleatório). */
+    uint8_t mac[32];        /* SHA-512(chave de MAC | keyId | iv | sealed), truncado. */
+
+    typedef wire::Fields<WIRE_FIELD(session_ticket, keyId), WIRE_FIELD(session_ticket, iv),
+                         WIRE_FIELD(session_ticket, sealed), WIRE_FIELD(session_ticket, mac)> Wire;
+} Ticket;
+
+/*  SYN de retomada: um SYN seguido de um ticket.
+    Os campos iniciais coincidem com structSyn; o tamanho na rede diferencia os dois.
+*/
+typedef struct resume
+{
+    bool message = SYN;
+    Nonce nonce;
+    Ticket ticket;
+    uint8_t proof[PROOF_SIZE];  /* HASH(chave de sessão | IV | nonce): posse da chave do ticket. */
+
+    typedef wire::Fields<WIRE_FIELD(resume, message), WIRE_FIELD(resume, nonce), WIRE_FIELD(resume, ticket),
+                         WIRE_FIELD(resume, proof)> Wire;
+} structResume;
+
+/*  Resposta a uma retomada aceita.
+    Os campos iniciais coincidem com structAck; o tamanho na rede diferencia os dois.
+*/
+typedef struct resume_ack
+{
+    bool message = ACK;
+    Nonce nonceA;
+    Nonce nonceB;
+    uint8_t proof[PROOF_SIZE];  /* HASH(nova chave | novo IV | nonceA | nonceB). */
+    Ticket ticket;      /* Ticket para a próxima retomada. */
+
+    typedef wire::Fields<WIRE_FIELD(resume_ack, message), WIRE_FIELD(resume_ack, nonceA), WIRE_FIELD(resume_ack, nonceB),
+                         WIRE_FIELD(resume_ack, proof), WIRE_FIELD(resume_ack, ticket)> Wire;
+} structResumeAck;
+
 typedef struct DH_ACK 
 {
     bool message = ACK;
-    char nonce[129];
+    Nonce nonce;
+    Ticket ticket;      /* Ticket para retomar esta sessão (keyId 0 sem TICKETS). */
+
+    typedef wire::Fields<WIRE_FIELD(DH_ACK, message), WIRE_FIELD(DH_ACK, nonce), WIRE_FIELD(DH_ACK, ticket)> Wire;
 } DH_ACK;
 
 /* Definição do tipo "byte" utilizado. */
@@ -50,6 +223,8 @@ typedef unsigned char byte;
 typedef struct rsa_key
 {
     int d, n;
+
+    typedef wire::Fields<WIRE_FIELD(rsa_key, d), WIRE_FIELD(rsa_key, n)> Wire;
 } RSAKey;
 
 /* Definição da struct que contém o par de chaves RSA. */
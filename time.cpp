@@ -1,13 +1,82 @@
 #include "time.h"
 
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define HAS_TSC 1
+#else
+#define HAS_TSC 0
+#endif
+
+/* Conversão do TSC, fixada por calibrateTSC(). */
+static bool tscActive = false;
+static double nsPerTick;
+static uint64_t tscBase, nsBase;
+
+static uint64_t monotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+uint64_t nanoTime()
+{
+#if HAS_TSC
+    if (tscActive)
+        return nsBase + (uint64_t)((__rdtsc() - tscBase) * nsPerTick);
+#endif
+    return monotonicNs();
+}
+
 double currentTime()
 {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (double)(tv.tv_sec) + (double)(tv.tv_usec)/ 1000000.00;
+    return nanoTime() / 1000000000.0;
 }
 
 double elapsedTime(double t1, double t2)
 {
     return (double)(t2-t1)*1000;
-}
\ No newline at end of file
+}
+
+bool calibrateTSC(int ms)
+{
+#if HAS_TSC
+    /* CPUID 0x80000007, EDX bit 8: TSC com frequência constante em todos os estados. */
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8)))
+        return false;
+
+    const uint64_t ns1 = monotonicNs();
+    const uint64_t tsc1 = __rdtsc();
+
+    struct timespec wait = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&wait, NULL);
+
+    const uint64_t ns2 = monotonicNs();
+    const uint64_t tsc2 = __rdtsc();
+
+    if (tsc2 <= tsc1 || ns2 <= ns1)
+        return false;
+
+    nsPerTick = (double)(ns2 - ns1) / (double)(tsc2 - tsc1);
+    tscBase = tsc2;
+    nsBase = ns2;
+    tscActive = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *clockSource()
+{
+    return tscActive ? "tsc" : "monotonic";
+}
+
+#if USE_TSC
+/* Calibra antes de main(), enquanto o processo ainda tem uma única thread. */
+static const bool tscCalibrated = calibrateTSC();
+#endif
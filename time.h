@@ -1,11 +1,37 @@
 #ifndef TIME_H
 #define TIME_H
 
+#include <stdint.h>
 #include <sys/time.h>
 #include <string>
 
+/*  Ativa a calibração do TSC na inicialização do processo (-DUSE_TSC=true).
+    Sem TSC invariante o relógio monotônico do sistema continua em uso.
+*/
+#ifndef USE_TSC
+#define USE_TSC false
+#endif
+
+/*  Tempo monotônico em nanossegundos, imune a ajustes do relógio (NTP).
+    Usa o TSC calibrado quando ativo, senão CLOCK_MONOTONIC.
+*/
+uint64_t nanoTime();
+
+/*  Tempo monotônico em segundos, com resolução de nanossegundos.
+    Serve apenas para medir intervalos com elapsedTime().
+*/
 double currentTime();
 
+/*  Intervalo entre dois valores de currentTime(), em ms. */
 double elapsedTime(double t1, double t2);
 
+/*  Mede a frequência do TSC contra CLOCK_MONOTONIC durante 'ms' e passa a
+    usá-lo em nanoTime(). Retorna false, mantendo o relógio do sistema, se
+    a CPU não tiver TSC invariante. Deve ser chamada antes de criar threads.
+*/
+bool calibrateTSC(int ms = 50);
+
+/*  Nome da fonte em uso: "tsc" ou "monotonic". */
+const char *clockSource();
+
 #endif
@@ -0,0 +1,181 @@
+/*  Trace Decoder
+    Lê um arquivo gerado por trace::start() e imprime os eventos em texto,
+    ou um resumo com a duração de cada Step (tempo desde o evento anterior
+    da mesma sessão) e a contagem de falhas por status.
+
+    Uso: ./trace_decoder arquivo [-s sessão] [--summary]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "trace.h"
+#include "../settings.h"
+
+#define EVENTS (trace::RESUME + 1)
+#define STATUSES (NOT_CONNECTED + 1)
+
+static const char *sideName[2] = {"server", "client"};
+
+static const char *eventName[2][EVENTS] = {
+    {"begin", "recv_syn", "send_ack", "recv_rsa", "send_rsa", "recv_rsa_ack", "send_dh", "recv_dh",
+     "send_dh_ack", "fail", "publish", "receive", "disconnect", "dropped", "resume"},
+    {"begin", "send_syn", "recv_ack", "send_rsa", "recv_rsa", "send_rsa_ack", "recv_dh", "send_dh",
+     "recv_dh_ack", "fail", "publish", "receive", "disconnect", "dropped", "resume"},
+};
+
+static const char *statusName[STATUSES] = {"OK", "DENIED", "TIMEOUT", "NO_REPLY", "NONCE_INVALID",
+                                           "FDR_INVALID", "HASH_INVALID", "FINISHED", "NOT_CONNECTED"};
+
+static const char *nameOf(const trace::Event &e)
+{
+    return e.side < 2 && e.step < EVENTS ? eventName[e.side][e.step] : "?";
+}
+
+static const char *statusOf(const trace::Event &e)
+{
+    return e.status < STATUSES ? statusName[e.status] : "?";
+}
+
+static bool load(const char *path, std::vector<trace::Event> &events)
+{
+    FILE *in = fopen(path, "rb");
+    if (in == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    char magic[8];
+    uint32_t header[2];
+    if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 ||
+        fread(header, sizeof(header), 1, in) != 1 || header[1] != sizeof(trace::Event))
+    {
+        fprintf(stderr, "%s: not a trace file\n", path);
+        fclose(in);
+        return false;
+    }
+
+    trace::Event e;
+    while (fread(&e, sizeof(e), 1, in) == 1)
+        events.push_back(e);
+    fclose(in);
+
+    /* O drainer grava os rings um após o outro: ordena pelo tempo. */
+    std::stable_sort(events.begin(), events.end(), [](const trace::Event &a, const trace::Event &b) {
+        return a.timestamp < b.timestamp;
+    });
+    return true;
+}
+
+static void summary(std::vector<trace::Event> &events)
+{
+    std::map<std::pair<int, uint32_t>, uint64_t> last;     /* (lado, sessão) -> último evento. */
+    std::vector<double> duration[2][EVENTS];                 /* Em µs. */
+    int failures[2][STATUSES] = {{0}};
+    unsigned long dropped = 0;
+
+    for (trace::Event &e : events)
+    {
+        if (e.step == trace::DROPPED)
+        {
+            dropped += e.session;
+            continue;
+        }
+        if (e.side > 1 || e.step >= EVENTS)
+            continue;
+
+        const std::pair<int, uint32_t> key(e.side, e.session);
+        auto it = last.find(key);
+        if (it != last.end() && e.step != trace::BEGIN)
+            duration[e.side][e.step].push_back((e.timestamp - it->second) / 1000.0);
+        last[key] = e.timestamp;
+
+        if (e.step == trace::FAIL && e.status < STATUSES)
+            failures[e.side][e.status]++;
+    }
+
+    printf("%-6s %-13s %8s %10s %10s %10s %10s\n", "side", "event", "count", "mean(us)", "p50(us)", "p99(us)", "max(us)");
+    for (int side = 0; side < 2; side++)
+        for (int step = 1; step < EVENTS; step++)
+        {
+            std::vector<double> &v = duration[side][step];
+            if (v.empty())
+                continue;
+
+            std::sort(v.begin(), v.end());
+            double mean = 0;
+            for (double d : v)
+                mean += d;
+            mean /= v.size();
+
+            printf("%-6s %-13s %8zu %10.2f %10.2f %10.2f %10.2f\n", sideName[side], eventName[side][step], v.size(),
+                   mean, v[(v.size() - 1) / 2], v[(size_t)((v.size() - 1) * 0.99)], v.back());
+        }
+
+    for (int side = 0; side < 2; side++)
+        for (int s = 0; s < STATUSES; s++)
+            if (failures[side][s])
+                printf("%s failed with %s: %d\n", sideName[side], statusName[s], failures[side][s]);
+
+    if (dropped)
+        printf("dropped events: %lu\n", dropped);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = NULL;
+    bool showSummary = false;
+    long session = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            session = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--summary"))
+            showSummary = true;
+        else if (path == NULL && argv[i][0] != '-')
+            path = argv[i];
+        else
+            path = NULL, i = argc;
+    }
+
+    if (path == NULL)
+    {
+        fprintf(stderr, "Usage: %s file [-s session] [--summary]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<trace::Event> events;
+    if (!load(path, events))
+        return 1;
+
+    if (showSummary)
+    {
+        summary(events);
+        return 0;
+    }
+
+    const uint64_t origin = events.empty() ? 0 : events.front().timestamp;
+    for (trace::Event &e : events)
+    {
+        if (session >= 0 && e.session != (uint32_t)session)
+            continue;
+
+        if (e.step == trace::DROPPED)
+        {
+            printf("%14.6f ms  t%-3u dropped %u events\n", (e.timestamp - origin) / 1e6, e.thread, e.session);
+            continue;
+        }
+
+        printf("%14.6f ms  t%-3u %-6s session %-8u %-13s %s\n", (e.timestamp - origin) / 1e6, e.thread,
+               e.side < 2 ? sideName[e.side] : "?", e.session, nameOf(e), statusOf(e));
+    }
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "trace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trace
+{
+
+std::atomic<bool> enabled(false);
+
+static std::mutex registry;
+static std::vector<Ring *> rings;   /* Nunca liberados: threads podem manter o ponteiro. */
+static thread_local Ring *local = NULL;
+
+static std::atomic<uint32_t> sessions(0);
+
+static FILE *file = NULL;
+static std::thread drainer;
+static std::atomic<bool> running(false);
+
+Ring *threadRing()
+{
+    if (local == NULL)
+    {
+        std::lock_guard<std::mutex> lock(registry);
+        local = new Ring((uint8_t)rings.size());
+        rings.push_back(local);
+    }
+    return local;
+}
+
+uint32_t newSession()
+{
+    return sessions.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+/* Copia para o arquivo tudo o que estiver nos rings. */
+static void drain()
+{
+    Event batch[256];
+
+    std::lock_guard<std::mutex> lock(registry);
+    for (Ring *ring : rings)
+    {
+        size_t n;
+        while ((n = ring->pop(batch, 256)) > 0)
+            fwrite(batch, sizeof(Event), n, file);
+    }
+}
+
+static void drainLoop()
+{
+    while (running)
+    {
+        drain();
+        /* Mantém o arquivo útil mesmo se o processo for interrompido. */
+        fflush(file);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    drain();
+}
+
+bool start(const char *path)
+{
+    if (running)
+        return true;
+
+    file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    /* Cabeçalho: magic, versão e tamanho de cada evento. */
+    const uint32_t header[2] = {1, sizeof(Event)};
+    fwrite(TRACE_MAGIC, 1, strlen(TRACE_MAGIC), file);
+    fwrite(header, sizeof(header), 1, file);
+
+    running = true;
+    drainer = std::thread(drainLoop);
+    enabled = true;
+    return true;
+}
+
+void stop()
+{
+    if (!running)
+        return;
+
+    enabled = false;
+    running = false;
+    drainer.join();
+
+    /* Um evento DROPPED por thread que perdeu eventos com o ring cheio. */
+    std::lock_guard<std::mutex> lock(registry);
+    for (Ring *ring : rings)
+    {
+        const uint64_t dropped = ring->dropped.exchange(0);
+        if (dropped == 0)
+            continue;
+
+        Event e;
+        memset(&e, 0, sizeof(e));
+        e.timestamp = nanoTime();
+        e.session = dropped > UINT32_MAX ? UINT32_MAX : (uint32_t)dropped;
+        e.step = DROPPED;
+        e.thread = ring->thread;
+        fwrite(&e, sizeof(e), 1, file);
+    }
+
+    fclose(file);
+    file = NULL;
+}
+
+}
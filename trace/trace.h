@@ -0,0 +1,128 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "../time.h"
+
+/*  Trace binário dos handshakes.
+    Cada thread escreve eventos de 16 bytes em um ring buffer próprio, sem
+    locks nem formatação; uma thread de fundo esvazia os rings em um
+    arquivo, que é lido depois pelo decodificador (trace/decoder.cpp).
+*/
+namespace trace
+{
+
+/* Lado que emitiu o evento. */
+enum
+{
+    SERVER = 0,
+    CLIENT = 1,
+};
+
+/* Eventos. Os valores 1 a 8 são os Steps do handshake. */
+enum
+{
+    BEGIN = 0,          /* Início do handshake.                         */
+    LAST_STEP = 8,
+    FAIL = 9,           /* Handshake interrompido; status indica o motivo. */
+    PUBLISH = 10,
+    RECEIVE = 11,
+    DISCONNECT = 12,
+    DROPPED = 13,       /* Registrado pelo drainer: session = eventos perdidos. */
+    RESUME = 14,        /* Sessão retomada com ticket, no lugar dos Steps 2 a 8. */
+};
+
+typedef struct event
+{
+    uint64_t timestamp; /* nanoTime(), em ns. */
+    uint32_t session;
+    uint8_t step;
+    uint8_t side;
+    uint8_t status;
+    uint8_t thread;
+} Event;
+
+#define TRACE_MAGIC "GWTRACE1"
+#define TRACE_RING_SIZE 4096 /* Eventos por thread; potência de 2. */
+
+/*  Ring de uma única thread produtora, esvaziado pelo drainer.
+    Quando cheio o evento é descartado e contado, nunca bloqueia.
+*/
+class Ring
+{
+  public:
+    Ring(uint8_t thread) : thread(thread) {}
+
+    void push(const Event &e)
+    {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= TRACE_RING_SIZE)
+        {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        slots[h & (TRACE_RING_SIZE - 1)] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    /* Chamado apenas pelo drainer. Retorna o número de eventos copiados. */
+    size_t pop(Event *out, size_t max)
+    {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        const uint64_t available = head.load(std::memory_order_acquire) - t;
+        const size_t n = available < max ? available : max;
+
+        for (size_t i = 0; i < n; i++)
+            out[i] = slots[(t + i) & (TRACE_RING_SIZE - 1)];
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    const uint8_t thread;
+    std::atomic<uint64_t> dropped{0};
+
+  private:
+    std::atomic<uint64_t> head{0};
+    char padding[64];
+    std::atomic<uint64_t> tail{0};
+    Event slots[TRACE_RING_SIZE];
+};
+
+extern std::atomic<bool> enabled;
+
+/* Ring da thread atual, criado e registrado no primeiro uso. */
+Ring *threadRing();
+
+/* Identificador novo para um handshake. */
+uint32_t newSession();
+
+/*  Abre o arquivo e inicia o drainer. Retorna false se o arquivo não
+    puder ser criado.
+*/
+bool start(const char *path);
+
+/* Esvazia os rings restantes e fecha o arquivo. */
+void stop();
+
+/* Registra um evento; sem custo além de um load quando o trace está desligado. */
+static inline void record(uint8_t side, uint8_t step, uint32_t session, int status)
+{
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+
+    Ring *ring = threadRing();
+    Event e;
+    e.timestamp = nanoTime();
+    e.session = session;
+    e.step = step;
+    e.side = side;
+    e.status = (uint8_t)status;
+    e.thread = ring->thread;
+    ring->push(e);
+}
+
+}
+
+#endif
@@ -0,0 +1 @@
+g++ -std=c++14 -O2 $1 -o trace_decoder trace/decoder.cpp
@@ -1,4 +1,206 @@
 #include "utils.h"
+#include "random.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAS_SIMD 1
+#else
+#define HAS_SIMD 0
+#endif
+
+/******************** Hexadecimal ********************/
+
+static const char upperDigits[] = "0123456789ABCDEF";
+static const char lowerDigits[] = "0123456789abcdef";
+
+/*  Valor de um dígito hexadecimal (maiúsculo ou minúsculo), ou -1. */
+static int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+#if HAS_SIMD
+/* Resolvidos uma vez; antes disso (inicialização estática) vale o caminho escalar. */
+static const bool hasSSSE3 = (__builtin_cpu_init(), __builtin_cpu_supports("ssse3"));
+static const bool hasAVX2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+
+/*  16 bytes em 32 dígitos: pshufb troca cada nibble pelo seu dígito e
+    unpack intercala os nibbles altos e baixos.
+*/
+__attribute__((target("ssse3")))
+static void encode16(const uint8_t *bytes, char *hex, const char *digits)
+{
+    const __m128i table = _mm_loadu_si128((const __m128i *)digits);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+
+    const __m128i in = _mm_loadu_si128((const __m128i *)bytes);
+    const __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+    const __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(in, mask));
+
+    _mm_storeu_si128((__m128i *)hex, _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128((__m128i *)(hex + 16), _mm_unpackhi_epi8(high, low));
+}
+
+/*  32 bytes em 64 dígitos. O unpack do AVX2 trabalha em cada metade de
+    128 bits, então as metades são reordenadas antes de gravar.
+*/
+__attribute__((target("avx2")))
+static void encode32(const uint8_t *bytes, char *hex, const char *digits)
+{
+    const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)digits));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    const __m256i in = _mm256_loadu_si256((const __m256i *)bytes);
+    const __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+    const __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(in, mask));
+
+    const __m256i first = _mm256_unpacklo_epi8(high, low);
+    const __m256i second = _mm256_unpackhi_epi8(high, low);
+    _mm256_storeu_si256((__m256i *)hex, _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256((__m256i *)(hex + 32), _mm256_permute2x128_si256(first, second, 0x31));
+}
+
+/*  Valores dos 16 dígitos em 'in'; 'valid' fica com 0xFF onde havia um dígito. */
+__attribute__((target("ssse3")))
+static __m128i digits16(__m128i in, __m128i *valid)
+{
+    const __m128i digit = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+
+    /* Comparações sem sinal: x <= n equivale a min(x, n) == x. */
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+    *valid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+/*  32 dígitos em 16 bytes: maddubs junta cada par em 16 * alto + baixo e
+    packus estreita para bytes. Retorna false se houver um dígito inválido.
+*/
+__attribute__((target("ssse3")))
+static bool decode16(const char *hex, uint8_t *bytes)
+{
+    const __m128i weights = _mm_set1_epi16(0x0110);
+
+    __m128i valid0, valid1;
+    const __m128i first = digits16(_mm_loadu_si128((const __m128i *)hex), &valid0);
+    const __m128i second = digits16(_mm_loadu_si128((const __m128i *)(hex + 16)), &valid1);
+    if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xFFFF)
+        return false;
+
+    const __m128i pairs = _mm_packus_epi16(_mm_maddubs_epi16(first, weights), _mm_maddubs_epi16(second, weights));
+    _mm_storeu_si128((__m128i *)bytes, pairs);
+    return true;
+}
+
+__attribute__((target("avx2")))
+static __m256i digits32(__m256i in, __m256i *valid)
+{
+    const __m256i digit = _mm256_sub_epi8(in, _mm256_set1_epi8('0'));
+    const __m256i letter = _mm256_sub_epi8(_mm256_or_si256(in, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+
+    const __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+
+    *valid = _mm256_or_si256(isDigit, isLetter);
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+                           _mm256_and_si256(isLetter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+/*  64 dígitos em 32 bytes; o packus do AVX2 também intercala as metades. */
+__attribute__((target("avx2")))
+static bool decode32(const char *hex, uint8_t *bytes)
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+
+    __m256i valid0, valid1;
+    const __m256i first = digits32(_mm256_loadu_si256((const __m256i *)hex), &valid0);
+    const __m256i second = digits32(_mm256_loadu_si256((const __m256i *)(hex + 32)), &valid1);
+    if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1)
+        return false;
+
+    const __m256i pairs = _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights), _mm256_maddubs_epi16(second, weights));
+    _mm256_storeu_si256((__m256i *)bytes, _mm256_permute4x64_epi64(pairs, 0xD8));
+    return true;
+}
+#endif
+
+/*  Hex Encode
+    Do fim para o começo: os dígitos do byte i caem em 2i e 2i+1, e cada
+    bloco é lido inteiro antes de ser sobrescrito, o que permite a
+    codificação no próprio buffer.
+*/
+void hexEncode(const uint8_t *bytes, size_t count, char *hex, bool upper)
+{
+    const char *digits = upper ? upperDigits : lowerDigits;
+
+    /* Bytes cobertos por blocos SIMD inteiros; o restante, no fim, vai byte a byte. */
+    size_t blocks = 0;
+#if HAS_SIMD
+    const size_t width = hasAVX2 ? 32 : hasSSSE3 ? 16 : 0;
+    if (width > 0)
+        blocks = count - count % width;
+#endif
+
+    for (size_t i = count; i > blocks; i--)
+    {
+        const uint8_t value = bytes[i - 1];
+        hex[2 * (i - 1)] = digits[value >> 4];
+        hex[2 * (i - 1) + 1] = digits[value & 0x0F];
+    }
+
+#if HAS_SIMD
+    for (size_t i = blocks; i > 0; i -= width)
+    {
+        if (width == 32)
+            encode32(bytes + i - 32, hex + 2 * (i - 32), digits);
+        else
+            encode16(bytes + i - 16, hex + 2 * (i - 16), digits);
+    }
+#endif
+}
+
+/*  Hex Decode
+    Do começo para o fim: o byte i é gravado antes dos dígitos ainda não
+    lidos, o que permite a decodificação no próprio buffer.
+*/
+bool hexDecode(const char *hex, size_t count, uint8_t *bytes)
+{
+    size_t i = 0;
+
+#if HAS_SIMD
+    if (hasAVX2)
+    {
+        for (; i + 32 <= count; i += 32)
+            if (!decode32(hex + 2 * i, bytes + i))
+                return false;
+    }
+    else if (hasSSSE3)
+    {
+        for (; i + 16 <= count; i += 16)
+            if (!decode16(hex + 2 * i, bytes + i))
+                return false;
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        const int high = hexDigit(hex[2 * i]);
+        const int low = hexDigit(hex[2 * i + 1]);
+        if (high < 0 || low < 0)
+            return false;
+        bytes[i] = high << 4 | low;
+    }
+    return true;
+}
 
 /*  Char to Uint_8t
     Converte um array de chars para um array de uint8_t.
@@ -13,15 +215,9 @@ void CharToUint8_t(char* charArray, uint8_t* byteArray, int size)
 /*  Uint8_t to Hex String
     Converte um array de uint8_t em uma string codificada em hexadecimal.
 */
-string Uint8_tToHexString(uint8_t* i, int quant){
-  string saida = "";
-
-  for(int j = 0; j < quant; j++){
-    char buffer [3];
-    sprintf(buffer,"%02X",i[j]);
-    saida += buffer;
-  }
-
+string Uint8_tToHexString(const uint8_t* i, int quant){
+  string saida(2 * quant, '\0');
+  hexEncode(i, quant, &saida[0], true);
   return saida;
 }
 
@@ -43,13 +239,7 @@ string Uint8_tToString(uint8_t* i, int quant)
 */
 void HexStringToCharArray(string* hexString, int sizeHexString, char* charArray)
 {
-    char hexStringChar[sizeHexString];
-    strncpy(hexStringChar, hexString->c_str(), sizeHexString);
-
-    uint8_t byteArray[sizeHexString/2];
-
-    HexStringToByteArray(hexStringChar, sizeHexString, byteArray, sizeHexString/2);
-    ByteToChar(byteArray, charArray, sizeHexString/2);
+    hexDecode(hexString->c_str(), sizeHexString/2, (uint8_t *)charArray);
 }
 
 /*  Byte Array to Hex String
@@ -57,17 +247,12 @@ void HexStringToCharArray(string* hexString, int sizeHexString, char* charArray)
 */
 int ByteArrayToHexString(uint8_t *byte_array, int byte_array_len, char *hexstr, int hexstr_len)
 {
-    int off = 0;
-    int i;
-
-    for (i = 0; i < byte_array_len; i ++) {
-        off += snprintf(hexstr + off, hexstr_len - off,
-                           "%02x", byte_array[i]);
-    }
+    const int count = byte_array_len < (hexstr_len - 1) / 2 ? byte_array_len : (hexstr_len - 1) / 2;
 
-    hexstr[off] = '\0';
+    hexEncode(byte_array, count, hexstr, false);
+    hexstr[2 * count] = '\0';
 
-    return off;
+    return 2 * count;
 }
 
 /*  Hex String to Byte Array
@@ -75,9 +260,28 @@ int ByteArrayToHexString(uint8_t *byte_array, int byte_array_len, char *hexstr,
 */
 void HexStringToByteArray(char *hexstr, int hexstr_len, uint8_t *byte_array, int byte_array_len)
 {
-    string received_hexa (hexstr);
-    vector<unsigned char> bytes_vector = hex_to_bytes(received_hexa);
-    std::copy(bytes_vector.begin(), bytes_vector.end(), byte_array);
+    const int count = (int)strnlen(hexstr, hexstr_len) / 2;
+    hexDecode(hexstr, count < byte_array_len ? count : byte_array_len, byte_array);
+}
+
+/*  Hex String to Bytes In Place
+    Decodifica a string hexadecimal no próprio buffer: o byte i ocupa a
+    posição i, sobrescrevendo os dígitos já lidos. Retorna o número de
+    bytes, ou -1 se houver um dígito inválido.
+*/
+int HexStringToBytesInPlace(char *hexstr, int hexstr_len)
+{
+    const int count = hexstr_len / 2;
+    return hexDecode(hexstr, count, (uint8_t *)hexstr) ? count : -1;
+}
+
+/*  Bytes to Hex String In Place
+    Codifica os 'count' primeiros bytes do buffer em hexadecimal (maiúsculo),
+    no próprio buffer, que precisa comportar 2 * count bytes.
+*/
+void BytesToHexStringInPlace(uint8_t *bytes, int count)
+{
+    hexEncode(bytes, count, (char *)bytes, true);
 }
 
 /*  Char to Byte
@@ -103,34 +307,28 @@ void ByteToChar(byte* bytes, char* chars, unsigned int count)
 */
 std::vector<unsigned char> hex_to_bytes(std::string const& hex)
 {
-    std::vector<unsigned char> bytes;
-    bytes.reserve(hex.size() / 2);
-    for (std::string::size_type i = 0, i_end = hex.size(); i < i_end; i += 2)
-    {
-        unsigned byte;
-        std::istringstream hex_byte(hex.substr(i, 2));
-        hex_byte >> std::hex >> byte;
-        bytes.push_back(static_cast<unsigned char>(byte));
-    }
+    std::vector<unsigned char> bytes(hex.size() / 2);
+    hexDecode(hex.data(), bytes.size(), bytes.data());
     return bytes;
 }
 
-std::string stringTime()
+/*  Random Bytes
+    Preenche o buffer com bytes aleatórios do gerador da thread (csprng),
+    para chaves e IVs.
+*/
+void randomBytes(void *buffer, size_t size)
 {
-    time_t timer;
-    struct tm *currentTime;
-
-    time(&timer); // Obtem informações de data e hora
-    currentTime = localtime(&timer); // Converte a hora atual para a hora local
-
-    int day = currentTime->tm_mday;
-    int month = currentTime->tm_mon + 1;
-    int year = currentTime->tm_year + 1900;
-
-    int hour = currentTime->tm_hour;
-    int min  = currentTime->tm_min;
-    int sec  = currentTime->tm_sec;
+    csprng::fill(buffer, size);
+}
 
-    string result = std::to_string(hour) + ":" + std::to_string(min) + ":" + std::to_string(sec);
-    return result;
-}
\ No newline at end of file
+/*  Constant Time Equals
+    Compara dois buffers sempre percorrendo todos os bytes, para não revelar
+    quantos bytes de um MAC estavam corretos.
+*/
+bool constantTimeEquals(const void *a, const void *b, size_t size)
+{
+    uint8_t difference = 0;
+    for (size_t i = 0; i < size; i++)
+        difference |= ((const uint8_t *)a)[i] ^ ((const uint8_t *)b)[i];
+    return difference == 0;
+}
@@ -15,60 +15,6 @@
 
 using namespace std;
 
-/*  Função auxiliar utilizada pela função 'Object to Bytes'.
-    Converte um objeto T em um array de bytes.
-*/
-template<typename T>
-array< byte, sizeof(T)> to_bytes(const T& object)
-{
-    std::array< byte, sizeof(T) > bytes ;
-
-    const byte* begin = reinterpret_cast< const byte* >( std::addressof(object) ) ;
-    const byte* end = begin + sizeof(T) ;
-    std::copy( begin, end, std::begin(bytes) ) ;
-
-    return bytes ;
-}
-
-/*  Função auxiliar utilizada pela função 'Bytes to Object'.
-    Converte um array de bytes em um objeto T.
-*/
-template<typename T>
-T& from_bytes(const array<byte, sizeof(T)> &bytes, T& object)
-{
-    // http://en.cppreference.com/w/cpp/types/is_trivially_copyable
-    static_assert( std::is_trivially_copyable<T>::value, "not a TriviallyCopyable type" ) ;
-
-    byte* begin_object = reinterpret_cast< byte* >( std::addressof(object) ) ;
-    std::copy( std::begin(bytes), std::end(bytes), begin_object ) ;
-
-    return object ;
-}
-
-/*  Object to Bytes
-    Converte um objeto qualquer para um array de bytes.
-*/
-template<typename T>
-void ObjectToBytes(T& object, byte byteArray[], int size)
-{
-    memset(byteArray, 0, size);
-    array<byte, sizeof(object)> array_bytes = to_bytes(object);
-    copy(array_bytes.begin(), array_bytes.end(), byteArray);
-}
-
-/*  Bytes to Object
-    Converte um array de bytes em sua representação como objeto.
-*/
-template<typename T>
-void BytesToObject(byte byteArray[], T& object, int size)
-{
-    array<byte, sizeof(T)> array_bytes;
-    for (int i = 0; i < size; i++)
-        array_bytes.at(i) = byteArray[i];
-
-    object = from_bytes(array_bytes, object);
-}
-
 string Uint8_tToString(uint8_t* i, int quant);
 
 /*  Char to Uint_8t
@@ -79,7 +25,7 @@ void CharToUint8_t(char* charArray, uint8_t* byteArray, int size);
 /*  Uint8_t to Hex String
 Converte um array de uint8_t em uma string codificada em hexadecimal.
 */
-string Uint8_tToHexString(uint8_t* i, int quant);
+string Uint8_tToHexString(const uint8_t* i, int quant);
 
 /*  Hex String to Char Array
     Converte uma string codificada em hexadecimal para um array de chars.
@@ -96,6 +42,33 @@ int ByteArrayToHexString(uint8_t *byte_array, int byte_array_len, char *hexstr,
 */
 void HexStringToByteArray(char *hexstr, int hexstr_len, uint8_t *byte_array, int byte_array_len);
 
+/*  Hex String to Bytes In Place
+    Decodifica a string hexadecimal no próprio buffer: o byte i ocupa a
+    posição i, sobrescrevendo os dígitos já lidos. Retorna o número de
+    bytes, ou -1 se houver um dígito inválido.
+*/
+int HexStringToBytesInPlace(char *hexstr, int hexstr_len);
+
+/*  Bytes to Hex String In Place
+    Codifica os 'count' primeiros bytes do buffer em hexadecimal (maiúsculo),
+    no próprio buffer, que precisa comportar 2 * count bytes.
+*/
+void BytesToHexStringInPlace(uint8_t *bytes, int count);
+
+/*  Hex Encode
+    Escreve os 2 * count dígitos hexadecimais de 'bytes' em 'hex', sem
+    terminador. Usa AVX2 ou SSSE3 quando a CPU tiver, e 'hex' pode ser o
+    próprio buffer de 'bytes'.
+*/
+void hexEncode(const uint8_t *bytes, size_t count, char *hex, bool upper = true);
+
+/*  Hex Decode
+    Lê 2 * count dígitos (maiúsculos ou minúsculos) de 'hex' e escreve
+    'count' bytes em 'bytes', que pode ser o próprio buffer de 'hex'.
+    Retorna false se houver um dígito inválido.
+*/
+bool hexDecode(const char *hex, size_t count, uint8_t *bytes);
+
 /*  Char to Byte
     Converte um array de chars para um array de bytes.
 */
@@ -113,6 +86,16 @@ std::vector<unsigned char> hex_to_bytes(std::string const& hex);
 
 
 
-std::string stringTime();
+/*  Random Bytes
+    Preenche o buffer com bytes aleatórios do gerador da thread (csprng),
+    para chaves e IVs.
+*/
+void randomBytes(void *buffer, size_t size);
+
+/*  Constant Time Equals
+    Compara dois buffers sempre percorrendo todos os bytes, para não revelar
+    quantos bytes de um MAC estavam corretos.
+*/
+bool constantTimeEquals(const void *a, const void *b, size_t size);
 
 #endif
@@ -1,18 +1,21 @@
 #include "verbose_client.h"
 
-void send_syn_verbose(char *nonceA)
+namespace client_verbose
+{
+
+void send_syn_verbose(const Nonce &nonceA)
 {
     cout << "Step 1.1" << endl;
     cout << "*********** SEND SYN **************************************************" << endl;
-    cout << "nA: " << nonceA << " (gen)" << endl;
+    cout << "nA: " << Uint8_tToHexString(nonceA.bytes, NONCE_SIZE) << " (gen)" << endl;
     cout << "***********************************************************************\n"   << endl;
 }
 
-void recv_ack_verbose(char *nonceB, int sequence, char *serverIP, char *clientIP, bool isNonceTrue)
+void recv_ack_verbose(const Nonce &nonceB, int sequence, char *serverIP, char *clientIP, bool isNonceTrue)
 {
     cout << "Step 2.2" << endl;
     cout << "*********** RECV ACK **************************************************" << endl;
-    cout << "nB: " << nonceB << " (stored)" << endl;
+    cout << "nB: " << Uint8_tToHexString(nonceB.bytes, NONCE_SIZE) << " (stored)" << endl;
     cout << "Sequence: " << sequence << endl;
     cout << "Server IP: " << serverIP << endl;
     cout << "Client IP: " << clientIP << endl;
@@ -20,7 +23,7 @@ void recv_ack_verbose(char *nonceB, int sequence, char *serverIP, char *clientIP
     cout << "***********************************************************************\n"   << endl;
 }
 
-void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, char *nonceA)
+void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, const Nonce &nonceA)
 {
     cout << "Step 3.1" << endl;
     cout << "************ SEND RSA *************************************************" << endl;
@@ -30,29 +33,29 @@ void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, char *nonceA)
          << rsaStorage->getMyPrivateKey()->n << ")}" << endl;
     cout << "My FDR: " << rsaStorage->getMyFDR()->toString() << endl;
     cout << "Sequence: " << sequence << endl;
-    cout << "nA: " << nonceA << " (gen)" << endl;
+    cout << "nA: " << Uint8_tToHexString(nonceA.bytes, NONCE_SIZE) << " (gen)" << endl;
     cout << "***********************************************************************\n" << endl;
 }
 
-void recv_rsa_verbose(RSAStorage *rsaStorage, char *nonceB, bool isHashValid, bool isNonceTrue, bool isAnswerCorrect)
+void recv_rsa_verbose(RSAStorage *rsaStorage, const Nonce &nonceB, bool isHashValid, bool isNonceTrue, bool isAnswerCorrect)
 {
     cout << "Step 4.2" << endl;
         cout << "************ RECV RSA *************************************************" << endl;
         cout << "Server Public Key: (" << rsaStorage->getPartnerPublicKey()->d
                 << ", " << rsaStorage->getPartnerPublicKey()->n << ")" << endl;
-        cout << "nB: " << nonceB << " (stored)" << endl;
+        cout << "nB: " << Uint8_tToHexString(nonceB.bytes, NONCE_SIZE) << " (stored)" << endl;
         cout << "Is Hash Valid? " << isHashValid << endl;
         cout << "Is Nonce True? " << isNonceTrue << endl;
         cout << "Is Answer Correct? " << isAnswerCorrect << endl;
         cout << "***********************************************************************\n" << endl;
 }
 
-void send_rsa_ack_verbose(int sequence, char *nonceA)
+void send_rsa_ack_verbose(int sequence, const Nonce &nonceA)
 {
     cout << "Step 5.1" << endl;
     cout << "************ SEND ACK RSA *********************************************" << endl;
     cout << "Sequence: " << sequence << endl;
-    cout << "nA: " << nonceA << " (gen)" << endl << endl << endl;
+    cout << "nA: " << Uint8_tToHexString(nonceA.bytes, NONCE_SIZE) << " (gen)" << endl << endl << endl;
     cout << "***********************************************************************\n" << endl;
 
 }
@@ -69,7 +72,7 @@ void recv_dh_verbose(DiffieHellmanPackage *dhPackage, bool isHashValid, bool isN
     cout << "Result: " << dhPackage->getResult() << endl;
     cout << "g: " << dhPackage->getBase() << endl;
     cout << "p: " << dhPackage->getModulus() << endl;
-    cout << "nB: " << dhPackage->getNonceB() << " (stored)" << endl;
+    cout << "nB: " << Uint8_tToHexString(dhPackage->getNonceB().bytes, NONCE_SIZE) << " (stored)" << endl;
     cout << "IV: " << dhPackage->getIV() << endl;
     cout << "Is Hash Valid? " << isHashValid << endl;
     cout << "Is Nonce True? " << isNonceTrue << endl;
@@ -82,7 +85,7 @@ void send_dh_verbose(DiffieHellmanPackage *dhPackage, int sessionKey, int sequen
         cout << "************ SEND DH **************************************************" << endl;
         cout << "Session Key: " << sessionKey << endl;
         cout << "Sequence: " << sequence << endl;
-        cout << "nA: " << dhPackage->getNonceB() << " (gen)" << endl;
+        cout << "nA: " << Uint8_tToHexString(dhPackage->getNonceB().bytes, NONCE_SIZE) << " (gen)" << endl;
         cout << "tp: " << tp << " ms" << endl;
         cout << "***********************************************************************\n" << endl;
 }
@@ -92,7 +95,7 @@ void send_dh_ack_verbose(DH_ACK *ack, bool isNonceTrue)
         cout << "Step 8.2" << endl;
         cout << "************ RECV DH ACK **********************************************" << endl;
         cout << "ACK" << endl;
-        cout << "nA: " << ack->nonce << endl;
+        cout << "nA: " << Uint8_tToHexString(ack->nonce.bytes, NONCE_SIZE) << endl;
         cout << "isNonceTrue? " << isNonceTrue << endl;
         cout << "***********************************************************************\n" << endl;
 }
@@ -211,4 +214,6 @@ void status_verbose(status s)
                         cout << "NOT_CONNECTED" << endl;
                         break;
         }
-}
\ No newline at end of file
+}
+
+}
@@ -7,14 +7,21 @@
 #include "../RSA/RSAKeyExchange.h"
 #include "../Diffie-Hellman/DHStorage.h"
 #include "../Diffie-Hellman/DiffieHellmanPackage.h"
+#include "../utils.h"
 
 using namespace std;
 
-void send_syn_verbose(char *nonce);
-void recv_ack_verbose(char *nonceB, int sequence, char *serverIP, char *clientIP, bool isNonceTrue);
-void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, char *nonceA);
-void recv_rsa_verbose(RSAStorage *rsaStorage, char *nonceB, bool isHashValid, bool isNonceTrue, bool isAnswerCorrect);
-void send_rsa_ack_verbose(int sequence, char *nonceA);
+/*  Funções de verbose do Cliente, separadas em um namespace para que
+    Servidor e Cliente possam ser ligados no mesmo binário.
+*/
+namespace client_verbose
+{
+
+void send_syn_verbose(const Nonce &nonce);
+void recv_ack_verbose(const Nonce &nonceB, int sequence, char *serverIP, char *clientIP, bool isNonceTrue);
+void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, const Nonce &nonceA);
+void recv_rsa_verbose(RSAStorage *rsaStorage, const Nonce &nonceB, bool isHashValid, bool isNonceTrue, bool isAnswerCorrect);
+void send_rsa_ack_verbose(int sequence, const Nonce &nonceA);
 void recv_dh_verbose(DiffieHellmanPackage *dhPackage, bool isHashValid, bool isNonceTrue);
 void send_dh_verbose(DiffieHellmanPackage *dhPackage, int sessionKey, int sequence, double tp);
 void send_dh_ack_verbose(DH_ACK *ack, bool isNonceTrue);
@@ -39,4 +46,6 @@ void reply_verbose(status s);
 
 void status_verbose(status s);
 
+}
+
 #endif
\ No newline at end of file
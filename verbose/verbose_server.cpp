@@ -1,37 +1,40 @@
 #include "verbose_server.h"
 
-void recv_syn_verbose(char *nonceA)
+namespace server_verbose
+{
+
+void recv_syn_verbose(const Nonce &nonceA)
 {
         cout << "Step 1.2" << endl;
     cout << "*********** RECV SYN **************************************************" << endl;
-    cout << "nA: " << nonceA << " (stored)" << endl;
+    cout << "nA: " << Uint8_tToHexString(nonceA.bytes, NONCE_SIZE) << " (stored)" << endl;
     cout << "***********************************************************************\n"   << endl;
 }
 
-void send_ack_verbose(char *nonceB, int sequence, char *serverIP, char *clientIP)
+void send_ack_verbose(const Nonce &nonceB, int sequence, char *serverIP, char *clientIP)
 {
         cout << "Step 2.1" << endl;
         cout << "*********** SEND ACK **************************************************" << endl;
-        cout << "nB: " << nonceB << " (gen)" << endl;
+        cout << "nB: " << Uint8_tToHexString(nonceB.bytes, NONCE_SIZE) << " (gen)" << endl;
         cout << "Sequence: " << sequence << endl << endl;
         cout << "Server IP: " << serverIP << endl;
         cout << "Client IP: " << clientIP << endl;
         cout << "***********************************************************************\n"   << endl;
 }
 
-void recv_rsa_verbose(RSAStorage *rsaStorage, char *nonceA, bool isHashValid, bool isNonceTrue)
+void recv_rsa_verbose(RSAStorage *rsaStorage, const Nonce &nonceA, bool isHashValid, bool isNonceTrue)
 {
         cout << "Step 3.2" << endl;
         cout << "************ RECV RSA *************************************************" << endl;
         cout << "Client Public Key: {(" << rsaStorage->getPartnerPublicKey()->d
                 << ", " << rsaStorage->getPartnerPublicKey()->n << ")" << endl;
-        cout << "nA: " << nonceA << " (stored)" << endl;
+        cout << "nA: " << Uint8_tToHexString(nonceA.bytes, NONCE_SIZE) << " (stored)" << endl;
         cout << "Is Hash Valid? " << isHashValid << endl;
         cout << "Is Nonce True? " << isNonceTrue << endl;
         cout << "***********************************************************************\n" << endl;
 }
 
-void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, char *nonceB)
+void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, const Nonce &nonceB)
 {
         cout << "Step 4.1" << endl;
     cout << "************ SEND RSA *************************************************" << endl;
@@ -41,15 +44,15 @@ void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, char *nonceB)
          << rsaStorage->getMyPrivateKey()->n << ")}" << endl;
     cout << "My FDR: " << rsaStorage->getMyFDR()->toString() << endl;
     cout << "Sequence: " << sequence << endl << endl;
-    cout << "nB: " << nonceB << " (gen)" << endl;
+    cout << "nB: " << Uint8_tToHexString(nonceB.bytes, NONCE_SIZE) << " (gen)" << endl;
     cout << "***********************************************************************\n" << endl;
 }
 
-void recv_rsa_ack_verbose(char *nonceA, bool isHashValid, bool isAnswerCorrect, bool isNonceTrue)
+void recv_rsa_ack_verbose(const Nonce &nonceA, bool isHashValid, bool isAnswerCorrect, bool isNonceTrue)
 {
         cout << "Step 5.2" << endl;
         cout << "************ RECV ACK RSA *********************************************" << endl;
-        cout << "nA: " << nonceA << " (stored)" << endl;
+        cout << "nA: " << Uint8_tToHexString(nonceA.bytes, NONCE_SIZE) << " (stored)" << endl;
         cout << "Is Hash Valid? " << isHashValid << endl;
         cout << "Is Nonce True? " << isNonceTrue << endl;
         cout << "Is Answer Correct? " << isAnswerCorrect << endl;
@@ -69,7 +72,7 @@ void send_dh_verbose(DiffieHellmanPackage *dhPackage, int sequence, double tp)
         cout << "g: " << dhPackage->getBase() << endl;
         cout << "p: " << dhPackage->getModulus() << endl;
         cout << "Sequence: " << sequence << endl;
-        cout << "nB: " << dhPackage->getNonceB() << " (gen)" << endl;
+        cout << "nB: " << Uint8_tToHexString(dhPackage->getNonceB().bytes, NONCE_SIZE) << " (gen)" << endl;
         cout << "IV: " << dhPackage->getIV() << endl;
         cout << "tp: " << tp << " ms" << endl;
         cout << "***********************************************************************\n" << endl;
@@ -80,7 +83,7 @@ void recv_dh_verbose(DiffieHellmanPackage *dhPackage, int sessionKey, bool isHas
     cout << "Step 7.2" << endl;
     cout << "************ RECV DH **************************************************" << endl;
     cout << "Session Key: " << sessionKey << endl;
-    cout << "nA: " << dhPackage->getNonceB() << " (stored)" << endl;
+    cout << "nA: " << Uint8_tToHexString(dhPackage->getNonceB().bytes, NONCE_SIZE) << " (stored)" << endl;
     cout << "Is Hash Valid? " << isHashValid << endl;
     cout << "Is Nonce True? " << isNonceTrue << endl;
     cout << "***********************************************************************\n" << endl;
@@ -91,7 +94,7 @@ void send_dh_ack_verbose(DH_ACK *ack)
         cout << "Step 8.1" << endl;
         cout << "************ SEND DH ACK **********************************************" << endl;
         cout << "ACK" << endl;
-        cout << "nA: " << ack->nonce << endl << endl;
+        cout << "nA: " << Uint8_tToHexString(ack->nonce.bytes, NONCE_SIZE) << endl << endl;
         cout << "***********************************************************************\n" << endl;
 }
 
@@ -197,4 +200,6 @@ void status_verbose(status s)
                         cout << "NOT_CONNECTED" << endl;
                         break;
         }
-}
\ No newline at end of file
+}
+
+}
@@ -6,15 +6,22 @@
 #include "../RSA/RSAStorage.h"
 #include "../Diffie-Hellman/DHStorage.h"
 #include "../Diffie-Hellman/DiffieHellmanPackage.h"
+#include "../utils.h"
 #include "../RSA/RSAKeyExchange.h"
 
 using namespace std;
 
-void recv_syn_verbose(char *nonceA);
-void send_ack_verbose(char *nonceB, int sequence, char *serverIP, char *clientIP);
-void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, char *nonceB);
-void recv_rsa_verbose(RSAStorage *rsaStorage, char *nonceA, bool isHashValid, bool isNonceTrue);
-void recv_rsa_ack_verbose(char *nonceA, bool isHashValid, bool isAnswerCorrect, bool isNonceTrue);
+/*  Funções de verbose do Servidor, separadas em um namespace para que
+    Servidor e Cliente possam ser ligados no mesmo binário.
+*/
+namespace server_verbose
+{
+
+void recv_syn_verbose(const Nonce &nonceA);
+void send_ack_verbose(const Nonce &nonceB, int sequence, char *serverIP, char *clientIP);
+void send_rsa_verbose(RSAStorage *rsaStorage, int sequence, const Nonce &nonceB);
+void recv_rsa_verbose(RSAStorage *rsaStorage, const Nonce &nonceA, bool isHashValid, bool isNonceTrue);
+void recv_rsa_ack_verbose(const Nonce &nonceA, bool isHashValid, bool isAnswerCorrect, bool isNonceTrue);
 void send_dh_verbose(DiffieHellmanPackage *dhPackage, int sequence, double tp);
 void recv_dh_verbose(DiffieHellmanPackage *dhPackage, int sessionKey, bool isHashValid, bool isNonceTrue);
 void send_dh_ack_verbose(DH_ACK *ack);
@@ -37,4 +44,6 @@ void reply_verbose(status s);
 
 void status_verbose(status s);
 
+}
+
 #endif
\ No newline at end of file
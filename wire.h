@@ -0,0 +1,200 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+/*  Codificação das mensagens do handshake para a rede.
+    Cada tipo descreve, em tempo de compilação, a lista dos seus campos
+    (WIRE_FIELD); a partir dela são gerados o tamanho e as funções de
+    codificação e decodificação. Os campos vão em sequência, sem padding:
+    inteiros e double em big-endian, textos (char[N]) em N - 1 bytes, sem
+    o terminador. Como todos os tamanhos são constantes, encode() e decode()
+    viram código linear, sem verificações por byte.
+*/
+namespace wire
+{
+
+/*  Formato de um tipo: 'size' bytes na rede, encode() e decode().
+    Tipos compostos descrevem seus campos em um typedef 'Wire' (ver Fields).
+*/
+template <typename T, typename Enable = void>
+struct Format : T::Wire
+{
+};
+
+/* Inteiros (e bool) em big-endian. */
+template <typename T>
+struct Format<T, typename std::enable_if<std::is_integral<T>::value>::type>
+{
+    static constexpr size_t size = sizeof(T);
+
+    static void encode(uint8_t *out, const T &value)
+    {
+        const uint64_t v = (uint64_t)value;
+        for (size_t i = 0; i < size; i++)
+            out[i] = (uint8_t)(v >> (8 * (size - 1 - i)));
+    }
+
+    static void decode(const uint8_t *in, T &value)
+    {
+        uint64_t v = 0;
+        for (size_t i = 0; i < size; i++)
+            v = v << 8 | in[i];
+        value = (T)v;
+    }
+};
+
+/* double pelos bits IEEE 754, em big-endian. */
+template <>
+struct Format<double>
+{
+    static constexpr size_t size = 8;
+
+    static void encode(uint8_t *out, const double &value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        Format<uint64_t>::encode(out, bits);
+    }
+
+    static void decode(const uint8_t *in, double &value)
+    {
+        uint64_t bits;
+        Format<uint64_t>::decode(in, bits);
+        memcpy(&value, &bits, sizeof(value));
+    }
+};
+
+/* Vetores, elemento a elemento. */
+template <typename T, size_t N>
+struct Format<T[N]>
+{
+    static constexpr size_t size = N * Format<T>::size;
+
+    static void encode(uint8_t *out, const T (&values)[N])
+    {
+        for (size_t i = 0; i < N; i++)
+            Format<T>::encode(out + i * Format<T>::size, values[i]);
+    }
+
+    static void decode(const uint8_t *in, T (&values)[N])
+    {
+        for (size_t i = 0; i < N; i++)
+            Format<T>::decode(in + i * Format<T>::size, values[i]);
+    }
+};
+
+/* Textos: o terminador não vai para a rede e é reposto na decodificação. */
+template <size_t N>
+struct Format<char[N]>
+{
+    static constexpr size_t size = N - 1;
+
+    static void encode(uint8_t *out, const char (&text)[N])
+    {
+        memcpy(out, text, N - 1);
+    }
+
+    static void decode(const uint8_t *in, char (&text)[N])
+    {
+        memcpy(text, in, N - 1);
+        text[N - 1] = '\0';
+    }
+};
+
+/*  Um campo de C, acessado pelo ponteiro para membro. */
+template <typename C, typename T, T C::*Member>
+struct Field
+{
+    static constexpr size_t size = Format<T>::size;
+
+    static void encode(uint8_t *out, const C &object)
+    {
+        Format<T>::encode(out, object.*Member);
+    }
+
+    static void decode(const uint8_t *in, C &object)
+    {
+        Format<T>::decode(in, object.*Member);
+    }
+};
+
+/*  Lista de campos, codificados um após o outro na ordem declarada. */
+template <typename... F>
+struct Fields;
+
+template <>
+struct Fields<>
+{
+    static constexpr size_t size = 0;
+
+    template <typename C>
+    static void encode(uint8_t *, const C &) {}
+
+    template <typename C>
+    static void decode(const uint8_t *, C &) {}
+};
+
+template <typename F, typename... Rest>
+struct Fields<F, Rest...>
+{
+    static constexpr size_t size = F::size + Fields<Rest...>::size;
+
+    template <typename C>
+    static void encode(uint8_t *out, const C &object)
+    {
+        F::encode(out, object);
+        Fields<Rest...>::encode(out + F::size, object);
+    }
+
+    template <typename C>
+    static void decode(const uint8_t *in, C &object)
+    {
+        F::decode(in, object);
+        Fields<Rest...>::decode(in + F::size, object);
+    }
+};
+
+/*  Bytes de T na rede. */
+template <typename T>
+constexpr size_t size()
+{
+    return Format<T>::size;
+}
+
+template <typename T>
+void encode(const T &object, uint8_t *out)
+{
+    Format<T>::encode(out, object);
+}
+
+template <typename T>
+void decode(const uint8_t *in, T &object)
+{
+    Format<T>::decode(in, object);
+}
+
+/*  Vetores cujo tamanho só é conhecido em tempo de execução (saídas do RSA). */
+template <typename T>
+void encode(const T *values, size_t count, uint8_t *out)
+{
+    for (size_t i = 0; i < count; i++)
+        Format<T>::encode(out + i * Format<T>::size, values[i]);
+}
+
+template <typename T>
+void decode(const uint8_t *in, size_t count, T *values)
+{
+    for (size_t i = 0; i < count; i++)
+        Format<T>::decode(in + i * Format<T>::size, values[i]);
+}
+
+}
+
+/*  Descritor do campo 'member' da classe 'type', para uso em um typedef Wire. */
+#define WIRE_FIELD(type, member) wire::Field<type, decltype(type::member), &type::member>
+
+#endif